@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2022-2024 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2022-2024 Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+   Benchmark of the C++ layer of png_wrapper.h
+
+   Reads dude.png many times with pngw::Image::read() and with the C calls it wraps, and prints the
+   time of each so that the overhead of the C++ layer can be compared. The amount of reads can be
+   given as the first argument.
+*/
+
+#include <pngw/pngw.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static int fail(const pngwresult_t result)
+{
+  std::printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+  return 1;
+}
+
+int main(int argc, char** argv)
+{
+  const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+
+  pngw::Image<PNGW_COLOR_RGBA, 8> dude;
+  pngwresult_t result = dude.read("dude.png");
+  if (result != PNGW_RESULT_OK)
+  {
+    return fail(result);
+  }
+  std::vector<pngwb_t> c_bytes(dude.size());
+
+  using clock = std::chrono::steady_clock;
+  const clock::time_point c_start = clock::now();
+  for (size_t i = 0; i < iterations; i++)
+  {
+    size_t width, height;
+    result = pngwFileInfo("dude.png", &width, &height, nullptr, nullptr);
+    if (result == PNGW_RESULT_OK)
+    {
+      result = pngwReadFile("dude.png", c_bytes.data(), PNGW_DEFAULT_ROW_OFFSET, width, height, 8,
+                            PNGW_COLOR_RGBA);
+    }
+    if (result != PNGW_RESULT_OK)
+    {
+      return fail(result);
+    }
+  }
+  const clock::time_point cpp_start = clock::now();
+  for (size_t i = 0; i < iterations; i++)
+  {
+    result = dude.read("dude.png");
+    if (result != PNGW_RESULT_OK)
+    {
+      return fail(result);
+    }
+  }
+  const clock::time_point end = clock::now();
+  const double c_time = std::chrono::duration<double, std::micro>(cpp_start - c_start).count();
+  const double cpp_time = std::chrono::duration<double, std::micro>(end - cpp_start).count();
+  std::printf("%zu reads of dude.png\n", iterations);
+  std::printf("pngwFileInfo() + pngwReadFile(): %.2f us per read\n", c_time / iterations);
+  std::printf("pngw::Image::read():            %.2f us per read\n", cpp_time / iterations);
+  return 0;
+}
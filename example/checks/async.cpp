@@ -0,0 +1,240 @@
+// SPDX-FileCopyrightText: 2022-2024 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2022-2024 Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <pngw/pngw_async.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Read = pngw::AsyncRead<PNGW_COLOR_RGBA, 8>;
+
+// Flag that threads can wait on until it is opened.
+class Gate
+{
+public:
+  void open()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->open_ = true;
+    }
+    this->condition_.notify_all();
+  }
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->condition_.wait(lock, [this] { return this->open_; });
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool open_ = false;
+};
+
+// Start a job that keeps the only worker thread of a pool busy until release is opened.
+static pngwresult_t blockWorker(pngw::AsyncPool& pool, Gate& started, Gate& release)
+{
+  const pngwresult_t result = pool.read<PNGW_COLOR_RGBA, 8>("dude.png", [&](Read&) {
+    started.open();
+    release.wait();
+  });
+  if (result == PNGW_RESULT_OK)
+  {
+    started.wait();
+  }
+  return result;
+}
+
+int main()
+{
+  printf("refusing jobs when the queue is full\n");
+  {
+    // the gates are used by the worker thread, so they must outlive the pool
+    Gate started, release;
+    pngw::AsyncPool pool(1, 1);
+    if (blockWorker(pool, started, release) != PNGW_RESULT_OK)
+    {
+      printf("an error has occured: the first job was refused\n");
+      return 1;
+    }
+    std::shared_ptr<Read> queued;
+    const pngwresult_t queued_result = pool.read<PNGW_COLOR_RGBA, 8>("dude.png", nullptr, &queued);
+    const pngwresult_t full_result = pool.read<PNGW_COLOR_RGBA, 8>("dude.png", nullptr);
+    const size_t pending = pool.pending();
+    release.open();
+    if (queued_result != PNGW_RESULT_OK || pending != 1 ||
+        full_result != PNGW_RESULT_ERROR_QUEUE_FULL)
+    {
+      printf("an error has occured: a job was accepted into a full queue\n");
+      return 2;
+    }
+    queued->wait();
+    if (queued->result() != PNGW_RESULT_OK || queued->take().width() != 24)
+    {
+      printf("an error has occured: the queued job was not read\n");
+      return 3;
+    }
+  }
+
+  printf("cancelling a job before it starts\n");
+  {
+    Gate started, release;
+    pngw::AsyncPool pool(1, 4);
+    if (blockWorker(pool, started, release) != PNGW_RESULT_OK)
+    {
+      printf("an error has occured: the first job was refused\n");
+      return 4;
+    }
+    std::atomic<int> calls{0};
+    pngwresult_t callback_result = PNGW_RESULT_OK;
+    std::shared_ptr<Read> job;
+    pool.read<PNGW_COLOR_RGBA, 8>(
+        "dude.png",
+        [&](Read& read) {
+          callback_result = read.result();
+          calls++;
+        },
+        &job);
+    job->cancel();
+    release.open();
+    job->wait();
+    if (calls != 1 || callback_result != PNGW_RESULT_ERROR_CANCELLED ||
+        job->result() != PNGW_RESULT_ERROR_CANCELLED || !job->take().empty())
+    {
+      printf("an error has occured: the cancelled job was run\n");
+      return 5;
+    }
+  }
+
+  printf("catching an exception thrown by a callback\n");
+  {
+    pngw::AsyncPool pool(1, 4);
+    std::shared_ptr<Read> job;
+    pool.read<PNGW_COLOR_RGBA, 8>(
+        "dude.png", [](Read&) { throw std::runtime_error("callback failed"); }, &job);
+    job->wait();
+    std::string message;
+    try
+    {
+      if (job->exception())
+      {
+        std::rethrow_exception(job->exception());
+      }
+    }
+    catch (const std::runtime_error& error)
+    {
+      message = error.what();
+    }
+    if (!job->done() || job->result() != PNGW_RESULT_OK || message != "callback failed")
+    {
+      printf("an error has occured: the exception of the callback was not kept\n");
+      return 6;
+    }
+    // the worker thread must still be running after the exception
+    std::shared_ptr<Read> next;
+    pool.read<PNGW_COLOR_RGBA, 8>("dude.png", nullptr, &next);
+    next->wait();
+    if (next->result() != PNGW_RESULT_OK || next->exception())
+    {
+      printf("an error has occured: the pool stopped working after an exception\n");
+      return 7;
+    }
+  }
+
+  printf("calling every callback once when the pool is destroyed\n");
+  {
+    std::atomic<size_t> calls{0};
+    std::vector<std::shared_ptr<Read>> queued;
+    std::shared_ptr<Read> first;
+    pngwresult_t refused_result = PNGW_RESULT_OK;
+    {
+      Gate full;
+      std::atomic<bool> destroying{false};
+      std::chrono::steady_clock::time_point deadline;
+      pngw::AsyncPool pool(1, 8);
+      const auto count = [&](Read&) { calls++; };
+      // the first job fills the queue behind itself, then keeps starting jobs until the pool
+      // refuses them because it is being destroyed
+      pool.read<PNGW_COLOR_RGBA, 8>(
+          "dude.png",
+          [&](Read&) {
+            calls++;
+            for (;;)
+            {
+              std::shared_ptr<Read> job;
+              const pngwresult_t result = pool.read<PNGW_COLOR_RGBA, 8>("dude.png", count, &job);
+              if (result == PNGW_RESULT_OK)
+              {
+                queued.push_back(std::move(job));
+              }
+              else if (result == PNGW_RESULT_ERROR_QUEUE_FULL &&
+                       (!destroying || std::chrono::steady_clock::now() < deadline))
+              {
+                full.open();
+                std::this_thread::yield();
+              }
+              else
+              {
+                refused_result = result;
+                return;
+              }
+            }
+          },
+          &first);
+      full.wait();
+      deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      destroying = true;
+    }
+    if (refused_result != PNGW_RESULT_ERROR_CANCELLED)
+    {
+      printf("an error has occured: a job started during destruction was not cancelled\n");
+      return 8;
+    }
+    if (queued.size() != 8 || calls != queued.size() + 1 || !first->done())
+    {
+      printf("an error has occured: %zu callbacks were called for %zu jobs\n", calls.load(),
+             queued.size() + 1);
+      return 9;
+    }
+    for (const std::shared_ptr<Read>& job : queued)
+    {
+      if (!job->done() || job->result() != PNGW_RESULT_ERROR_CANCELLED)
+      {
+        printf("an error has occured: a waiting job was not cancelled\n");
+        return 10;
+      }
+    }
+  }
+
+  return 0;
+}
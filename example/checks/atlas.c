@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2022-2024 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2022-2024 Daniel Aimé Valcour
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <pngw/png_wrapper.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SPRITE_COUNT 40
+#define MAX_WIDTH 128
+#define PADDING 2
+#define BACKGROUND 0xab
+
+static pngwb_t spriteSample(const size_t sprite, const size_t x, const size_t y, const size_t c)
+{
+  return c == 3 ? 255 : (pngwb_t)(sprite * 5 + x * (c + 1) + y * (c + 3));
+}
+
+static int overlaps(const pngwatlasrect_t* const a, const pngwatlasrect_t* const b)
+{
+  return a->x < b->x + b->width + PADDING && b->x < a->x + a->width + PADDING &&
+         a->y < b->y + b->height + PADDING && b->y < a->y + a->height + PADDING;
+}
+
+int main()
+{
+#ifdef _OPENMP
+  printf("png_wrapper.h is compiled with OpenMP, so sprites are read in parallel\n");
+#endif
+  printf("writing %d sprites of different sizes\n", SPRITE_COUNT);
+  char names[SPRITE_COUNT][32];
+  const char* paths[SPRITE_COUNT];
+  pngwb_t sprite[40 * 40 * 4];
+  for (size_t i = 0; i < SPRITE_COUNT; i++)
+  {
+    const size_t width = 1 + (i * 7) % 40, height = 1 + (i * 13) % 37;
+    for (size_t y = 0; y < height; y++)
+    {
+      for (size_t x = 0; x < width; x++)
+      {
+        for (size_t c = 0; c < 4; c++)
+        {
+          sprite[(y * width + x) * 4 + c] = spriteSample(i, x, y, c);
+        }
+      }
+    }
+    sprintf(names[i], "sprite_%zu.png", i);
+    paths[i] = names[i];
+    const pngwresult_t result = pngwWriteFile(paths[i], sprite, PNGW_DEFAULT_ROW_OFFSET, width,
+                                              height, 8, PNGW_COLOR_RGBA);
+    if (result != PNGW_RESULT_OK)
+    {
+      printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+      return 1;
+    }
+  }
+
+  printf("packing the sprites\n");
+  pngwatlasrect_t rects[SPRITE_COUNT];
+  size_t order[SPRITE_COUNT];
+  size_t atlas_width, atlas_height;
+  pngwresult_t result = pngwPackAtlas(paths, SPRITE_COUNT, MAX_WIDTH, PADDING, rects, order,
+                                      &atlas_width, &atlas_height);
+  if (result != PNGW_RESULT_OK)
+  {
+    printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+    return 2;
+  }
+  if (atlas_width > MAX_WIDTH)
+  {
+    printf("an error has occured: the atlas is wider than the max width\n");
+    return 3;
+  }
+  int packed[SPRITE_COUNT] = {0};
+  for (size_t i = 0; i < SPRITE_COUNT; i++)
+  {
+    if (order[i] >= SPRITE_COUNT || packed[order[i]] ||
+        (i > 0 && rects[order[i]].height > rects[order[i - 1]].height))
+    {
+      printf("an error has occured: the packing order is not from tallest to shortest\n");
+      return 4;
+    }
+    packed[order[i]] = 1;
+  }
+  for (size_t i = 0; i < SPRITE_COUNT; i++)
+  {
+    const pngwatlasrect_t* const rect = &rects[i];
+    if (rect->width != 1 + (i * 7) % 40 || rect->height != 1 + (i * 13) % 37 ||
+        rect->x + rect->width > atlas_width || rect->y + rect->height > atlas_height)
+    {
+      printf("an error has occured: sprite %zu is not inside of the atlas\n", i);
+      return 5;
+    }
+    if (rect->u0 != (float)rect->x / (float)atlas_width ||
+        rect->v0 != (float)rect->y / (float)atlas_height ||
+        rect->u1 != (float)(rect->x + rect->width) / (float)atlas_width ||
+        rect->v1 != (float)(rect->y + rect->height) / (float)atlas_height)
+    {
+      printf("an error has occured: the texture coordinates of sprite %zu are wrong\n", i);
+      return 6;
+    }
+    for (size_t j = 0; j < i; j++)
+    {
+      if (overlaps(rect, &rects[j]))
+      {
+        printf("an error has occured: sprites %zu and %zu are closer than the padding\n", j, i);
+        return 7;
+      }
+    }
+  }
+
+  printf("reading the sprites into a %zux%zu atlas\n", atlas_width, atlas_height);
+  const size_t row_size = atlas_width * 4;
+  pngwb_t* const atlas = malloc(row_size * atlas_height);
+  if (atlas == NULL)
+  {
+    printf("an error has occured: out of memory\n");
+    return 8;
+  }
+  memset(atlas, BACKGROUND, row_size * atlas_height);
+  result = pngwReadAtlas(paths, SPRITE_COUNT, rects, atlas, atlas_width, atlas_height - 1, 8,
+                         PNGW_COLOR_RGBA);
+  if (result != PNGW_RESULT_ERROR_INVALID_DIMENSIONS)
+  {
+    printf("an error has occured: sprites outside of the atlas were not refused\n");
+    return 9;
+  }
+  result = pngwReadAtlas(paths, SPRITE_COUNT, rects, atlas, atlas_width, atlas_height, 8,
+                         PNGW_COLOR_RGBA);
+  if (result != PNGW_RESULT_OK)
+  {
+    printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+    return 10;
+  }
+  // pixels of sprites hold the sprite, and all other pixels are left untouched
+  for (size_t y = 0; y < atlas_height; y++)
+  {
+    for (size_t x = 0; x < atlas_width; x++)
+    {
+      size_t sprite_index = SPRITE_COUNT;
+      for (size_t i = 0; i < SPRITE_COUNT; i++)
+      {
+        if (x >= rects[i].x && x < rects[i].x + rects[i].width && y >= rects[i].y &&
+            y < rects[i].y + rects[i].height)
+        {
+          sprite_index = i;
+        }
+      }
+      for (size_t c = 0; c < 4; c++)
+      {
+        const pngwb_t expected =
+            sprite_index == SPRITE_COUNT
+                ? BACKGROUND
+                : spriteSample(sprite_index, x - rects[sprite_index].x,
+                               y - rects[sprite_index].y, c);
+        if (atlas[y * row_size + x * 4 + c] != expected)
+        {
+          printf("an error has occured: atlas pixel %zu,%zu is wrong\n", x, y);
+          return 11;
+        }
+      }
+    }
+  }
+
+  printf("packing with a missing file and with a max width that is too small\n");
+  paths[3] = "missing.png";
+  if (pngwPackAtlas(paths, SPRITE_COUNT, MAX_WIDTH, PADDING, rects, order, &atlas_width,
+                    &atlas_height) != PNGW_RESULT_ERROR_FILE_NOT_FOUND)
+  {
+    printf("an error has occured: a missing file was not reported\n");
+    return 12;
+  }
+  paths[3] = names[3];
+  if (pngwPackAtlas(paths, SPRITE_COUNT, 20, PADDING, rects, order, &atlas_width,
+                    &atlas_height) != PNGW_RESULT_ERROR_INVALID_DIMENSIONS)
+  {
+    printf("an error has occured: a sprite wider than the max width was not refused\n");
+    return 13;
+  }
+
+  free(atlas);
+  return 0;
+}
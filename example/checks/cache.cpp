@@ -0,0 +1,333 @@
+// SPDX-FileCopyrightText: 2022-2024 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2022-2024 Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <pngw/pngw_cache.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using Cache = pngw::ImageCache<PNGW_COLOR_RGBA, 8>;
+
+// Memory resource that holds allocations until it is opened, so that a read can be kept in
+// progress, and that can be made to throw.
+class GateResource : public std::pmr::memory_resource
+{
+public:
+  void open()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->open_ = true;
+    }
+    this->condition_.notify_all();
+  }
+
+  void setThrowing(const bool throwing)
+  {
+    this->throwing_.store(throwing);
+  }
+
+  // Wait until an allocation is being held.
+  void waitForAllocation()
+  {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->condition_.wait(lock, [this] { return this->waiting_ > 0; });
+  }
+
+private:
+  void* do_allocate(const size_t bytes, const size_t alignment) override
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->mutex_);
+      this->waiting_++;
+      this->condition_.notify_all();
+      this->condition_.wait(lock, [this] { return this->open_; });
+      this->waiting_--;
+    }
+    if (this->throwing_.load())
+    {
+      throw std::runtime_error("allocation refused");
+    }
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* const p, const size_t bytes, const size_t alignment) override
+  {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+  {
+    return this == &other;
+  }
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool open_ = false;
+  size_t waiting_ = 0;
+  std::atomic<bool> throwing_{false};
+};
+
+static bool writeDude(const char* const path, const size_t size)
+{
+  pngw::Image<PNGW_COLOR_RGBA, 8> dude;
+  if (dude.read("dude.png") != PNGW_RESULT_OK)
+  {
+    return false;
+  }
+  return pngwWriteFile(path, dude.data(), PNGW_DEFAULT_ROW_OFFSET, size, size, 8,
+                       PNGW_COLOR_RGBA) == PNGW_RESULT_OK;
+}
+
+int main()
+{
+  const char* const paths[3] = {"cache_a.png", "cache_b.png", "cache_c.png"};
+  for (const char* const path : paths)
+  {
+    if (!writeDude(path, 24))
+    {
+      printf("an error has occured: could not write %s\n", path);
+      return 1;
+    }
+  }
+  const size_t image_size = 24 * 24 * 4;
+
+  printf("getting one image from many threads at once\n");
+  {
+    GateResource gate;
+    Cache cache(image_size * 4, &gate);
+    std::vector<Cache::handle_type> images(8);
+    std::vector<pngwresult_t> results(8, PNGW_RESULT_COUNT);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      threads.emplace_back([&, i] { results[i] = cache.get(paths[0], images[i]); });
+    }
+    gate.waitForAllocation();
+    gate.open();
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      if (results[i] != PNGW_RESULT_OK || images[i] != images[0])
+      {
+        printf("an error has occured: threads got different images\n");
+        return 2;
+      }
+    }
+    const pngw::CacheStats stats = cache.stats();
+    if (stats.misses != 1 || stats.hits != images.size() - 1 || stats.entries != 1)
+    {
+      printf("an error has occured: the file was read %zu times\n", stats.misses);
+      return 3;
+    }
+  }
+
+  printf("evicting the least recently used image\n");
+  {
+    Cache cache(image_size * 2);
+    Cache::handle_type image;
+    cache.get(paths[0], image);
+    cache.get(paths[1], image);
+    cache.get(paths[0], image);
+    cache.get(paths[2], image);
+    pngw::CacheStats stats = cache.stats();
+    if (stats.evictions != 1 || stats.entries != 2 || stats.bytes != image_size * 2)
+    {
+      printf("an error has occured: %zu images were evicted\n", stats.evictions);
+      return 4;
+    }
+    // cache_b.png was the least recently used, so it is the one that was evicted
+    cache.get(paths[0], image);
+    cache.get(paths[2], image);
+    cache.get(paths[1], image);
+    stats = cache.stats();
+    if (stats.hits != 3 || stats.misses != 4)
+    {
+      printf("an error has occured: the wrong image was evicted\n");
+      return 5;
+    }
+  }
+
+  printf("reading an image again after its file changed\n");
+  {
+    Cache cache(image_size * 4);
+    Cache::handle_type image;
+    cache.get(paths[0], image);
+    if (!writeDude(paths[0], 12))
+    {
+      printf("an error has occured: could not write %s\n", paths[0]);
+      return 6;
+    }
+    const pngwresult_t result = cache.get(paths[0], image);
+    if (result != PNGW_RESULT_OK || image->width() != 12 || cache.stats().misses != 2)
+    {
+      printf("an error has occured: the changed file was not read again\n");
+      return 7;
+    }
+    writeDude(paths[0], 24);
+  }
+
+  printf("invalidating and clearing while an image is being read\n");
+  for (int clear = 0; clear < 2; clear++)
+  {
+    GateResource gate;
+    Cache cache(image_size * 4, &gate);
+    Cache::handle_type image;
+    pngwresult_t result = PNGW_RESULT_COUNT;
+    std::thread thread([&] { result = cache.get(paths[0], image); });
+    gate.waitForAllocation();
+    if (clear)
+    {
+      cache.clear();
+    }
+    else
+    {
+      cache.invalidate(paths[0]);
+    }
+    gate.open();
+    thread.join();
+    if (result != PNGW_RESULT_OK || !image || cache.stats().entries != 0)
+    {
+      printf("an error has occured: an image read during %s was cached\n",
+             clear ? "clear()" : "invalidate()");
+      return 8;
+    }
+    cache.get(paths[0], image);
+    if (cache.stats().misses != 2 || cache.stats().entries != 1)
+    {
+      printf("an error has occured: the image was not read again\n");
+      return 9;
+    }
+  }
+
+  printf("getting a broken file from many threads at once\n");
+  {
+    FILE* f = fopen("cache_broken.png", "wb");
+    FILE* source = fopen(paths[0], "rb");
+    if (f == NULL || source == NULL)
+    {
+      printf("an error has occured: could not write cache_broken.png\n");
+      return 10;
+    }
+    pngwb_t bytes[4096];
+    const size_t size = fread(bytes, 1, sizeof(bytes), source);
+    fwrite(bytes, 1, size / 2, f);
+    fclose(source);
+    fclose(f);
+    GateResource gate;
+    Cache cache(image_size * 4, &gate);
+    std::vector<Cache::handle_type> images(8);
+    std::vector<pngwresult_t> results(8, PNGW_RESULT_OK);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      threads.emplace_back([&, i] { results[i] = cache.get("cache_broken.png", images[i]); });
+    }
+    gate.waitForAllocation();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    gate.open();
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      if (results[i] != PNGW_RESULT_ERROR_JUMP_BUFFER_CALLED || images[i])
+      {
+        printf("an error has occured: a thread did not get the read error\n");
+        return 11;
+      }
+    }
+    const size_t misses = cache.stats().misses;
+    Cache::handle_type image;
+    cache.get("cache_broken.png", image);
+    if (cache.stats().hits != 0 || cache.stats().entries != 0 || cache.stats().misses != misses + 1)
+    {
+      printf("an error has occured: the broken file was not read again\n");
+      return 12;
+    }
+  }
+
+  printf("getting an image from many threads while reading it throws\n");
+  {
+    GateResource gate;
+    gate.setThrowing(true);
+    Cache cache(image_size * 4, &gate);
+    std::vector<Cache::handle_type> images(8);
+    std::vector<pngwresult_t> results(8, PNGW_RESULT_OK);
+    std::atomic<size_t> thrown{0};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      threads.emplace_back([&, i] {
+        try
+        {
+          results[i] = cache.get(paths[0], images[i]);
+        }
+        catch (const std::runtime_error&)
+        {
+          results[i] = PNGW_RESULT_ERROR_OUT_OF_MEMORY;
+          thrown++;
+        }
+      });
+    }
+    gate.waitForAllocation();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    gate.open();
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      if (results[i] != PNGW_RESULT_ERROR_OUT_OF_MEMORY || images[i])
+      {
+        printf("an error has occured: a thread waiting on a throwing read got no error\n");
+        return 13;
+      }
+    }
+    if (thrown == 0 || cache.stats().entries != 0)
+    {
+      printf("an error has occured: the throwing read was not cleaned up\n");
+      return 14;
+    }
+    gate.setThrowing(false);
+    Cache::handle_type image;
+    if (cache.get(paths[0], image) != PNGW_RESULT_OK || !image)
+    {
+      printf("an error has occured: the image was not read again after a throwing read\n");
+      return 15;
+    }
+  }
+
+  return 0;
+}
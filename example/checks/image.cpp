@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2022-2024 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2022-2024 Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <pngw/pngw.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+int main()
+{
+  printf("reading dude.png with pngw::Image and with pngwReadFile()\n");
+  pngw::Image<PNGW_COLOR_RGBA, 8> image;
+  pngwresult_t result = image.read("dude.png");
+  if (result != PNGW_RESULT_OK)
+  {
+    printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+    return 1;
+  }
+  std::vector<pngwb_t> bytes(image.size());
+  result = pngwReadFile("dude.png", bytes.data(), PNGW_DEFAULT_ROW_OFFSET, image.width(),
+                        image.height(), 8, PNGW_COLOR_RGBA);
+  if (result != PNGW_RESULT_OK)
+  {
+    printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+    return 2;
+  }
+  if (std::memcmp(bytes.data(), image.data(), bytes.size()) != 0 ||
+      image.row(1).data() != image.samples().data() + image.width() * 4)
+  {
+    printf("an error has occured: pixel bytes are not the same\n");
+    return 3;
+  }
+
+  printf("moving the image\n");
+  pngw::Image<PNGW_COLOR_RGBA, 8> moved = std::move(image);
+  if (!image.empty() || moved.empty() || moved.width() != 24 || moved.height() != 24)
+  {
+    printf("an error has occured: the image was not moved\n");
+    return 4;
+  }
+
+  printf("reading a truncated copy of dude.png\n");
+  FILE* f = fopen("truncated_dude.png", "wb");
+  if (f == NULL)
+  {
+    printf("an error has occured: could not create truncated_dude.png\n");
+    return 5;
+  }
+  FILE* source = fopen("dude.png", "rb");
+  pngwb_t file_bytes[256];
+  const size_t file_size = source != NULL ? fread(file_bytes, 1, sizeof(file_bytes), source) : 0;
+  if (source != NULL)
+  {
+    fclose(source);
+  }
+  fwrite(file_bytes, 1, file_size / 2, f);
+  fclose(f);
+  result = moved.read("truncated_dude.png");
+  if (result == PNGW_RESULT_OK || !moved.empty())
+  {
+    printf("an error has occured: a failed read did not leave the image empty\n");
+    return 6;
+  }
+
+  printf("reading a file that does not exist\n");
+  result = moved.read("dude.png");
+  if (result == PNGW_RESULT_OK)
+  {
+    result = moved.read("missing.png");
+  }
+  if (result != PNGW_RESULT_ERROR_FILE_NOT_FOUND || !moved.empty())
+  {
+    printf("an error has occured: a missing file did not leave the image empty\n");
+    return 7;
+  }
+
+  return 0;
+}
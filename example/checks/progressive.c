@@ -0,0 +1,214 @@
+// SPDX-FileCopyrightText: 2022-2024 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2022-2024 Daniel Aimé Valcour
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <png.h>
+#include <pngw/png_wrapper.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct check_t
+{
+  const pngwb_t* source;
+  const pngwb_t* data;
+  size_t width;
+  size_t height;
+  size_t calls;
+  size_t next_pass;
+  size_t pass_count;
+  int in_order;
+  int block_filled;
+} check_t;
+
+// Write an RGBA image with a different color for every pixel, which pngwWriteFile() can not
+// interlace.
+static int writeTestImage(const char* const path, pngwb_t* const pixels, const size_t width,
+                          const size_t height, const int interlace)
+{
+  for (size_t i = 0; i < width * height * 4; i++)
+  {
+    pixels[i] = (pngwb_t)(i * 7 + i / 5);
+  }
+  FILE* f = fopen(path, "wb");
+  if (f == NULL)
+  {
+    return 0;
+  }
+  png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  png_infop info_ptr = png_ptr != NULL ? png_create_info_struct(png_ptr) : NULL;
+  if (info_ptr == NULL || setjmp(png_jmpbuf(png_ptr)))
+  {
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    fclose(f);
+    return 0;
+  }
+  png_init_io(png_ptr, f);
+  png_set_IHDR(png_ptr, info_ptr, (png_uint_32)width, (png_uint_32)height, 8,
+               PNG_COLOR_TYPE_RGB_ALPHA, interlace ? PNG_INTERLACE_ADAM7 : PNG_INTERLACE_NONE,
+               PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png_ptr, info_ptr);
+  const int passes = png_set_interlace_handling(png_ptr);
+  for (int pass = 0; pass < passes; pass++)
+  {
+    for (size_t y = 0; y < height; y++)
+    {
+      png_write_row(png_ptr, &pixels[y * width * 4]);
+    }
+  }
+  png_write_end(png_ptr, NULL);
+  png_destroy_write_struct(&png_ptr, &info_ptr);
+  fclose(f);
+  return 1;
+}
+
+static void onPass(void* const user, const size_t pass, const size_t pass_count)
+{
+  check_t* const check = (check_t*)user;
+  check->calls++;
+  check->pass_count = pass_count;
+  if (pass != check->next_pass)
+  {
+    check->in_order = 0;
+  }
+  check->next_pass = pass + 1;
+  if (pass == 0 && pass_count == 7)
+  {
+    // after the first pass, every 8x8 block holds the color of its top left pixel
+    for (size_t y = 0; y < check->height; y++)
+    {
+      for (size_t x = 0; x < check->width; x++)
+      {
+        const pngwb_t* const pixel = &check->data[(y * check->width + x) * 4];
+        const pngwb_t* const corner = &check->source[((y & ~7u) * check->width + (x & ~7u)) * 4];
+        if (memcmp(pixel, corner, 4) != 0)
+        {
+          check->block_filled = 0;
+        }
+      }
+    }
+  }
+}
+
+// Read a test image progressively a few bytes at a time, returning 0 on success or the line of
+// the failed check.
+static int checkProgressive(const size_t width, const size_t height, const int interlace)
+{
+  pngwb_t* const source = malloc(width * height * 4);
+  pngwb_t* const data = calloc(width * height * 4, 1);
+  pngwb_t* const file = malloc(64 * 1024);
+  int failed = 0;
+  size_t file_size = 0;
+  FILE* f = NULL;
+  if (source == NULL || data == NULL || file == NULL ||
+      !writeTestImage("progressive.png", source, width, height, interlace) ||
+      (f = fopen("progressive.png", "rb")) == NULL)
+  {
+    failed = __LINE__;
+  }
+  else
+  {
+    file_size = fread(file, 1, 64 * 1024, f);
+    fclose(f);
+  }
+  check_t check = {source, data, width, height, 0, 0, 0, 1, 1};
+  pngwprogressive_t progressive;
+  if (!failed && pngwProgressiveBegin(&progressive, data, PNGW_DEFAULT_ROW_OFFSET, width, height,
+                                      8, PNGW_COLOR_RGBA, onPass, &check) != PNGW_RESULT_OK)
+  {
+    failed = __LINE__;
+  }
+  if (!failed)
+  {
+    pngwresult_t result = PNGW_RESULT_OK;
+    for (size_t i = 0; i < file_size && result == PNGW_RESULT_OK; i += 13)
+    {
+      const size_t size = file_size - i < 13 ? file_size - i : 13;
+      result = pngwProgressivePush(&progressive, &file[i], size);
+    }
+    if (pngwProgressiveEnd(&progressive) != PNGW_RESULT_OK)
+    {
+      failed = __LINE__;
+    }
+  }
+  const size_t expected_passes = interlace ? 7 : 1;
+  if (!failed && (check.calls != expected_passes || check.pass_count != expected_passes ||
+                  !check.in_order))
+  {
+    failed = __LINE__;
+  }
+  if (!failed && !check.block_filled)
+  {
+    failed = __LINE__;
+  }
+  if (!failed && memcmp(source, data, width * height * 4) != 0)
+  {
+    failed = __LINE__;
+  }
+  if (!failed)
+  {
+    // without the last bytes of the file, the read does not complete
+    pngwProgressiveBegin(&progressive, data, PNGW_DEFAULT_ROW_OFFSET, width, height, 8,
+                         PNGW_COLOR_RGBA, NULL, NULL);
+    pngwProgressivePush(&progressive, file, file_size - 16);
+    if (pngwProgressiveEnd(&progressive) != PNGW_RESULT_ERROR_INCOMPLETE_DATA)
+    {
+      failed = __LINE__;
+    }
+  }
+  free(source);
+  free(data);
+  free(file);
+  return failed;
+}
+
+int main()
+{
+  const size_t sizes[4][2] = {{64, 64}, {1, 1}, {3, 5}, {37, 29}};
+  for (size_t i = 0; i < 4; i++)
+  {
+    for (int interlace = 0; interlace < 2; interlace++)
+    {
+      printf("reading a %zux%zu %s image progressively\n", sizes[i][0], sizes[i][1],
+             interlace ? "interlaced" : "non interlaced");
+      const int failed = checkProgressive(sizes[i][0], sizes[i][1], interlace);
+      if (failed)
+      {
+        printf("an error has occured: check at line %d failed\n", failed);
+        return 1;
+      }
+    }
+  }
+
+  printf("beginning a progressive read of floating point samples\n");
+  pngwprogressive_t progressive;
+  pngwb_t data[16];
+  if (pngwProgressiveBegin(&progressive, data, PNGW_DEFAULT_ROW_OFFSET, 1, 1, PNGW_DEPTH_FLOAT32,
+                           PNGW_COLOR_RGBA, NULL, NULL) != PNGW_RESULT_ERROR_INVALID_DEPTH)
+  {
+    printf("an error has occured: floating point depth was accepted\n");
+    return 2;
+  }
+
+  return 0;
+}
@@ -76,5 +76,60 @@ int main()
     return 6;
   }
 
+  // 16 bit samples are in native byte order, and are converted to linear light when loaded as
+  // floats. sRGB sample 256 is 0.000302 in linear light and 65280 is 0.991.
+  printf("checking 16 bit samples loaded as linear light floats\n");
+  const pngws_t gray_samples[2] = {256, 65280};
+  result = pngwWriteFile("gray16.png", (const pngwb_t*)gray_samples, PNGW_DEFAULT_ROW_OFFSET, 2, 1,
+                         16, PNGW_COLOR_G);
+  if (result != PNGW_RESULT_OK)
+  {
+    printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+    return 7;
+  }
+  float linear_samples[2];
+  result = pngwReadFile("gray16.png", (pngwb_t*)linear_samples, PNGW_DEFAULT_ROW_OFFSET, 2, 1,
+                        PNGW_DEPTH_FLOAT32, PNGW_COLOR_G);
+  if (result != PNGW_RESULT_OK)
+  {
+    printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+    return 8;
+  }
+  printf("loaded gray16.png as linear light: %f %f\n", linear_samples[0], linear_samples[1]);
+  if (linear_samples[0] < 0.000302f || linear_samples[0] > 0.000303f ||
+      linear_samples[1] < 0.9911f || linear_samples[1] > 0.9912f)
+  {
+    printf("an error has occured: linear light samples are not correct\n");
+    return 9;
+  }
+
+  // floats are converted back to sRGB when written. linear 0.001 is sRGB sample 847 and 0.5 is
+  // 48192, and samples outside of 0 to 1 are clamped.
+  printf("checking linear light floats written as 16 bit samples\n");
+  const float write_samples[4] = {0.001f, 0.5f, -1.0f, 2.0f};
+  result = pngwWriteFile("float.png", (const pngwb_t*)write_samples, PNGW_DEFAULT_ROW_OFFSET, 4, 1,
+                         PNGW_DEPTH_FLOAT32, PNGW_COLOR_G);
+  if (result != PNGW_RESULT_OK)
+  {
+    printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+    return 10;
+  }
+  pngws_t written_samples[4];
+  result = pngwReadFile("float.png", (pngwb_t*)written_samples, PNGW_DEFAULT_ROW_OFFSET, 4, 1, 16,
+                        PNGW_COLOR_G);
+  if (result != PNGW_RESULT_OK)
+  {
+    printf("an error has occured: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+    return 11;
+  }
+  printf("loaded float.png as 16 bit: %u %u %u %u\n", written_samples[0], written_samples[1],
+         written_samples[2], written_samples[3]);
+  if (written_samples[0] != 847 || written_samples[1] != 48192 || written_samples[2] != 0 ||
+      written_samples[3] != 65535)
+  {
+    printf("an error has occured: written float samples are not correct\n");
+    return 12;
+  }
+
   return 0;
 }
@@ -21,7 +21,7 @@
 */
 
 /*
-   png_wrapper.h v1.0.2
+   png_wrapper.h v2.0.0
    Easy to use wrapper arround libpng
    The source for this library can be found on GitHub:
    https://github.com/Journeyman-dev/png_wrapper.h
@@ -72,6 +72,8 @@
    Since png_wrapper.h is a wrapper around libpng, it shouldn't be surprising that libpng must also
    be included as a dependency to your project. You must include png.h, the main header for libpng,
    before you can implement png_wrapper.h.
+   The implementation also uses pow() from math.h, so on platforms where the math library is
+   seperate, such as Linux, it must be linked as well (for example with -lm).
 
    HOW TO DEBUG
    Many functions in png_wrapper.h return an enum value of type pngwresult_t. Result codes with
@@ -156,6 +158,10 @@
    bit depths of may use palette colors, png files cannot be loaded in this way and must be
    converted on load.
 
+   For renderers that work in linear light, images can also be loaded with floating point samples
+   by passing PNGW_DEPTH_FLOAT32 or PNGW_DEPTH_FLOAT16 as the depth. Color samples are converted to
+   linear light while each row is decoded, and alpha samples are scaled to range from 0 to 1.
+
    To write an image bytes to a new file, pngwWriteFile() function can be used. Images can not be
    converted on write, so the arguments passed in must match the image bytes exactly. Just like
    with loading, you can only save images with 8 or 16 bit depth and can not save images with
@@ -170,6 +176,45 @@
                return 1;
            }
 
+   If the bytes of a png file arrive over time, such as when downloading it, they can be decoded as
+   they arrive with a progressive read. A progressive read is started with pngwProgressiveBegin(),
+   which takes the same arguments as pngwReadFile() plus an optional function that is called after
+   each pass over the image. Interlaced png files are decoded in 7 passes, and after each pass the
+   byte array holds a blocky preview of the whole image that gets finer with every pass. Bytes are
+   decoded with pngwProgressivePush(), and the read is finished with pngwProgressiveEnd().
+
+           // this continues from the above code blocks
+           pngwprogressive_t progressive;
+           pngwresult_t result = pngwProgressiveBegin(&progressive, bytes, PNGW_DEFAULT_ROW_OFFSET,
+                image_width, image_height, load_depth, load_color, on_pass, NULL);
+           if (result != PNGW_RESULT_OK)
+           {
+               printf("error beginning progressive read: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+               return 1;
+           }
+           while (result == PNGW_RESULT_OK && (received = receive(buffer, sizeof(buffer))) > 0)
+           {
+               result = pngwProgressivePush(&progressive, buffer, received);
+           }
+           result = pngwProgressiveEnd(&progressive);
+
+   Many small png files can be read into a single atlas image. First, pngwPackAtlas() reads the
+   dimensions of each file and decides where it goes in the atlas. Then, after allocating a byte
+   array of the atlas size, pngwReadAtlas() reads every file directly into its place. Both
+   functions work on one file after another, unless the file that implements png_wrapper.h is
+   compiled with OpenMP enabled (for example with -fopenmp), in which case they work on multiple
+   files in parallel. The example project builds its atlas check both ways.
+
+           // this continues from the above code blocks
+           pngwatlasrect_t rects[SPRITE_COUNT];
+           size_t order[SPRITE_COUNT];
+           size_t atlas_width, atlas_height;
+           pngwresult_t result = pngwPackAtlas(sprite_paths, SPRITE_COUNT, 2048, 1, rects, order,
+                &atlas_width, &atlas_height);
+           // allocate and clear atlas_width * atlas_height pixels, then:
+           result = pngwReadAtlas(sprite_paths, SPRITE_COUNT, rects, atlas_bytes, atlas_width,
+                atlas_height, load_depth, load_color);
+
    Just like results, color type enum values also have a const char string array lookup table for
    string names.
 
@@ -185,12 +230,30 @@
     If you wish to convert between pngwcolor_t and libpng color type macros, you can use the functions
     pngwColorToPngColor() and pngwPngColorToColor().
 
+   HOW TO USE FROM C++
+   The header pngw/pngw.hpp provides the move only class template pngw::Image, which owns its pixel
+   bytes and carries its depth and color type as template arguments. It requires C++20 and calls
+   the functions in this file, so png_wrapper.h must still be implemented as described above. The
+   header pngw/pngw_cache.hpp provides pngw::ImageCache, a thread safe cache of decoded images with
+   a byte budget for reading the same files many times. The header pngw/pngw_async.hpp provides
+   pngw::AsyncPool, which reads and writes images on a pool of worker threads and reports completion
+   through callbacks or pollable job handles.
+
    CHANGELOG
    - Version 1.0
        Initial Release
    - Version 1.0.1
        Fixed handling of endianess with 16 bit images.
        Removed invalid arguments to png function call.
+   - Version 2.0.0
+       16 bit image samples are now stored in the byte order of the machine on both reads and
+       writes, so code that swapped them by hand on little endian machines must stop doing so.
+       Fixed pngwIsLittleEndianMachine(), which returned the wrong answer.
+       Added PNGW_DEPTH_FLOAT32 and PNGW_DEPTH_FLOAT16 for reading and writing linear samples.
+       Added pngwProgressiveBegin() and related functions for reading pngs in chunks, with a
+       callback after each Adam7 pass of an interlaced image.
+       Added pngwPackAtlas() and pngwReadAtlas() for packing many pngs into one atlas.
+       Added the C++20 headers pngw/pngw.hpp, pngw/pngw_cache.hpp and pngw/pngw_async.hpp.
  */
 
 #ifndef PNGW_H
@@ -217,7 +280,10 @@ extern "C"
     PNGW_RESULT_ERROR_INVALID_DEPTH = 7,
     PNGW_RESULT_ERROR_INVALID_COLOR = 8,
     PNGW_RESULT_ERROR_INVALID_DIMENSIONS = 9,
-    PNGW_RESULT_COUNT = 10
+    PNGW_RESULT_ERROR_INCOMPLETE_DATA = 10,
+    PNGW_RESULT_ERROR_CANCELLED = 11,
+    PNGW_RESULT_ERROR_QUEUE_FULL = 12,
+    PNGW_RESULT_COUNT = 13
   } pngwresult_t;
 
   // array of error descriptions, indexable by pngwresult_t enum values.
@@ -238,32 +304,128 @@ extern "C"
 
 #define PNGW_DEFAULT_ROW_OFFSET 0
 
+// Depths of floating point pixel bytes, which hold linear light samples that range from 0 to 1.
+// PNGW_DEPTH_FLOAT32 samples are floats, and PNGW_DEPTH_FLOAT16 samples are IEEE half precision
+// floats stored as pngws_t. The low byte of a depth is always its amount of bits per sample.
+#define PNGW_DEPTH_FLOAT_BIT 0x100
+#define PNGW_DEPTH_FLOAT16 (PNGW_DEPTH_FLOAT_BIT | 16)
+#define PNGW_DEPTH_FLOAT32 (PNGW_DEPTH_FLOAT_BIT | 32)
+
   // Get information about a png image file's format. Depth may be 1, 2, 4, 8, or 16. Color may be
   // any type.
   pngwresult_t pngwFileInfo(const char* const path, size_t* const width, size_t* const height,
                             size_t* const depth, pngwcolor_t* const color);
 
-  // Get the size of image data in bytes. Depth must be 8 or 16. Color may not be
-  // PNGW_COLOR_PALETTE.
+  // Get the size of image data in bytes. Depth must be 8, 16, PNGW_DEPTH_FLOAT16 or
+  // PNGW_DEPTH_FLOAT32. Color may not be PNGW_COLOR_PALETTE.
   pngwresult_t pngwDataSize(const size_t width, const size_t height, const size_t depth,
                             const pngwcolor_t color, size_t* const size);
 
   // Read png data from a file into a pixel byte array with the specified format. Data should be
   // allocated before this function is called with enough space to contain the bytes. If the file is
   // of a different format than specified in the arguments, the image will be converted on load.
-  // Depth must be 8 or 16. Color may not be PNGW_COLOR_PALETTE. Width and height must match the
-  // actual width and height of the image, which you can retrieve with pngwFileInfo() before
-  // loading.
+  // Depth must be 8, 16, PNGW_DEPTH_FLOAT16 or PNGW_DEPTH_FLOAT32. Floating point depths convert
+  // color samples to linear light using the transfer function from the file's sRGB or gAMA chunk,
+  // or the sRGB transfer function if it has neither. Color may not be PNGW_COLOR_PALETTE. Width and
+  // height must match the actual width and height of the image, which you can retrieve with
+  // pngwFileInfo() before loading.
   pngwresult_t pngwReadFile(const char* const path, pngwb_t* const data, const size_t row_offset,
                             const size_t width, const size_t height, const size_t depth,
                             const pngwcolor_t color);
 
+  // Called by a progressive read each time a pass over the image has been decoded. Pass is the
+  // index of the completed pass, and pass count is 7 for Adam7 interlaced images and 1 for other
+  // images. The function is called once for every pass in order, including passes that hold no
+  // pixels because the image is smaller than 8 pixels in a direction. After an interlaced pass,
+  // pixels that are not decoded yet hold a copy of the nearest decoded pixel above and to the left
+  // of them, so the pixel bytes can be shown as a preview.
+  typedef void (*pngwpassfn_t)(void* const user, const size_t pass, const size_t pass_count);
+
+  // State of a progressive read. Members are set by pngwProgressiveBegin() and should not be
+  // modified while the read is in progress.
+  typedef struct pngwprogressive_t
+  {
+    void* png_ptr;
+    void* info_ptr;
+    pngwb_t* data;
+    size_t row_offset;
+    size_t width;
+    size_t height;
+    size_t depth;
+    pngwcolor_t color;
+    pngwpassfn_t pass_fn;
+    void* user;
+    size_t pass;
+    size_t pass_count;
+    int done;
+    pngwresult_t result;
+  } pngwprogressive_t;
+
+  // Begin reading png data that arrives in pieces, such as over a network. Png file bytes are then
+  // given to pngwProgressivePush() as they arrive, and are decoded into the pixel byte array
+  // immediately. The arguments are the same as for pngwReadFile(), with the addition of a pass
+  // function that may be NULL and a user pointer that is passed to it. Only depths 8 and 16 can be
+  // read progressively, and floating point depths return PNGW_RESULT_ERROR_INVALID_DEPTH.
+  pngwresult_t pngwProgressiveBegin(pngwprogressive_t* const progressive, pngwb_t* const data,
+                                    const size_t row_offset, const size_t width,
+                                    const size_t height, const size_t depth,
+                                    const pngwcolor_t color, const pngwpassfn_t pass_fn,
+                                    void* const user);
+
+  // Decode the next bytes of a png file in a progressive read. Bytes do not have to contain whole
+  // chunks or rows. If an error occurs, the read is stopped and the same error is returned by all
+  // later calls.
+  pngwresult_t pngwProgressivePush(pngwprogressive_t* const progressive, const pngwb_t* const bytes,
+                                   const size_t size);
+
+  // End a progressive read, freeing its libpng state. This must be called for every successful
+  // call to pngwProgressiveBegin(), even if an error occured. Returns
+  // PNGW_RESULT_ERROR_INCOMPLETE_DATA if the end of the image was not reached.
+  pngwresult_t pngwProgressiveEnd(pngwprogressive_t* const progressive);
+
   // Save png data to a file from a pixel byte array. The width, height, depth and color must be be
-  // the same as the format of data bytes.
+  // the same as the format of data bytes. Pixel bytes with a floating point depth are saved as a 16
+  // bit depth sRGB image.
   pngwresult_t pngwWriteFile(const char* path, const pngwb_t* const data, const size_t row_offset,
                              const size_t width, const size_t height, const size_t depth,
                              const pngwcolor_t color);
 
+  // Position of an image within an atlas, in pixels and in texture coordinates that range from 0
+  // to 1.
+  typedef struct pngwatlasrect_t
+  {
+    size_t x;
+    size_t y;
+    size_t width;
+    size_t height;
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+  } pngwatlasrect_t;
+
+  // Pack png files into a single atlas image. The dimensions of each file are read and packed into
+  // rows no wider than max width, with padding pixels between images. Rects must have space for
+  // count elements, and is filled with the position of each file in the same order as paths. Order
+  // must also have space for count elements, and is filled with the indices of the files in the
+  // order they were packed, which is from tallest to shortest. The size of the whole atlas is
+  // stored in atlas width and atlas height.
+  pngwresult_t pngwPackAtlas(const char* const* const paths, const size_t count,
+                             const size_t max_width, const size_t padding,
+                             pngwatlasrect_t* const rects, size_t* const order,
+                             size_t* const atlas_width, size_t* const atlas_height);
+
+  // Read png files into their positions in an atlas that was packed with pngwPackAtlas(). Data
+  // should be allocated with enough space for an image of the atlas dimensions. Each file is
+  // converted on load to the specified format, just like with pngwReadFile(). If a rect does not
+  // fit within the atlas dimensions, PNGW_RESULT_ERROR_INVALID_DIMENSIONS is returned before any
+  // file is read. Pixels between the images are not written to. Files are read one after another,
+  // or in parallel if the implementation is compiled with OpenMP.
+  pngwresult_t pngwReadAtlas(const char* const* const paths, const size_t count,
+                             const pngwatlasrect_t* const rects, pngwb_t* const data,
+                             const size_t atlas_width, const size_t atlas_height,
+                             const size_t depth, const pngwcolor_t color);
+
   // Convert an 8 bit depth RGB color to a grayscale value using libpng's default conversion
   // equation.
   pngwb_t pngGrayFromColor8(const pngwb_t r, const pngwb_t g, const pngwb_t b);
@@ -272,6 +434,12 @@ extern "C"
   // equation.
   pngws_t pngGrayFromColor16(const pngws_t r, const pngws_t g, const pngws_t b);
 
+  // Convert a float to an IEEE half precision float, rounding to the nearest value.
+  pngws_t pngwFloatToHalf(const float value);
+
+  // Convert an IEEE half precision float to a float.
+  float pngwHalfToFloat(const pngws_t half);
+
   // Get the libpng color macro of a pngw color type.
   int pngwColorToPngColor(const pngwcolor_t color);
 
@@ -285,7 +453,9 @@ extern "C"
 #  ifndef PNGW_IMPLEMENTED
 #    define PNGW_IMPLEMENTED
 
+#    include <math.h>
 #    include <stdio.h>
+#    include <string.h>
 
 #    ifndef PNG_H
 #      error png.h must be included before png_wrapper.h can be implemented.
@@ -295,7 +465,8 @@ extern "C"
       "no error has occured",    "file not found at path", "failed to create file",
       "out of memory",           "invalid file signiture", "jump buffer called",
       "NULL argument",           "invalid bit depth",      "invalid color type",
-      "invalid pixel dimensions"};
+      "invalid pixel dimensions", "incomplete png data",    "operation cancelled",
+      "job queue is full"};
 
   const char* const PNGW_COLOR_NAMES[PNGW_COLOR_COUNT] = {"Palette", "G", "GA", "RGB", "RGBA"};
 
@@ -361,6 +532,21 @@ extern "C"
     return PNGW_RESULT_OK;
   }
 
+  // Get the size of a single sample in bytes, or 0 if the depth is not valid for pixel bytes.
+  static size_t pngwSampleSize(const size_t depth)
+  {
+    switch (depth)
+    {
+    case 8:
+    case 16:
+    case PNGW_DEPTH_FLOAT16:
+    case PNGW_DEPTH_FLOAT32:
+      return (depth & 0xff) / 8;
+    default:
+      return 0;
+    }
+  }
+
   pngwresult_t pngwDataSize(const size_t width, const size_t height, const size_t depth,
                             const pngwcolor_t color, size_t* const size)
   {
@@ -368,7 +554,7 @@ extern "C"
     {
       return PNGW_RESULT_ERROR_INVALID_COLOR;
     }
-    if (depth != 8 && depth != 16)
+    if (pngwSampleSize(depth) == 0)
     {
       return PNGW_RESULT_ERROR_INVALID_DEPTH;
     }
@@ -378,11 +564,739 @@ extern "C"
     }
     if (size != NULL)
     {
-      *size = width * height * (depth / 8) * ((size_t)color);
+      *size = width * height * pngwSampleSize(depth) * ((size_t)color);
     }
     return PNGW_RESULT_OK;
   }
 
+  // Configure libpng to convert the image being read to the requested depth and color.
+  static void pngwSetReadTransforms(png_structp png_ptr, png_infop info_ptr, const size_t depth,
+                                    const pngwcolor_t color)
+  {
+    const int png_bit_depth = png_get_bit_depth(png_ptr, info_ptr);
+    const int png_color_type = png_get_color_type(png_ptr, info_ptr);
+    int load_png_color_type = pngwColorToPngColor(color);
+    int load_png_bit_depth = (int)depth;
+    // if alpha channel not wanted, strip it if the image has one.
+    if ((png_color_type & PNG_COLOR_MASK_ALPHA) && !(load_png_color_type & PNG_COLOR_MASK_ALPHA))
+    {
+      png_set_strip_alpha(png_ptr);
+    }
+    // if expecting an alpha channel and none exists in the image, add a fully opaque alpha value to
+    // each pixel
+    if ((load_png_color_type & PNG_COLOR_MASK_ALPHA) &&
+        (png_color_type == PNG_COLOR_TYPE_GRAY || png_color_type == PNG_COLOR_TYPE_RGB ||
+         png_color_type == PNG_COLOR_TYPE_PALETTE))
+    {
+      png_set_filler(png_ptr, 0xffff, PNG_FILLER_AFTER);
+    }
+    // if multiple pixels are packed per byte on 8 bit depth, seperate them into seperate bytes
+    // cleanly
+    if (png_bit_depth < 8 && load_png_bit_depth == 8)
+    {
+      png_set_packing(png_ptr);
+    }
+    // if the image has bit depth 16 and 8 is wanted, auto convert it to bit depth 8
+    if (png_bit_depth == 16 && load_png_bit_depth == 8)
+    {
+#    ifdef PNG_READ_SCALE_16_TO_8_SUPPORTED
+      png_set_scale_16(png_ptr);
+#    else
+      png_set_strip_16(png_ptr);  // if scaling not supported, strip off the excess byte instead
+#    endif
+    }
+    // swap bytes of the loaded samples to native byte order
+    if (load_png_bit_depth == 16 && pngwIsLittleEndianMachine())
+    {
+      png_set_swap(png_ptr);
+    }
+    // if image has less than 16 bit depth and 16 is wanted, upscale it to 16
+    if (png_bit_depth < 16 && load_png_bit_depth == 16)
+    {
+      png_set_expand_16(png_ptr);
+    }
+    // if gray and bit depth is less than 8, up it to 8
+    if ((png_color_type == PNG_COLOR_TYPE_GRAY || png_color_type == PNG_COLOR_TYPE_GRAY_ALPHA) &&
+        png_bit_depth < 8)
+    {
+      png_set_expand_gray_1_2_4_to_8(png_ptr);
+    }
+    // auto convert palette images into rgb or rgba
+    if (png_color_type == PNG_COLOR_TYPE_PALETTE)
+    {
+      png_set_palette_to_rgb(png_ptr);
+    }
+    // set transparency to full alpha channels
+    if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS) != 0)
+    {
+      png_set_tRNS_to_alpha(png_ptr);
+    }
+    // set rgb image to gray output or vice versa
+    if ((load_png_color_type == PNG_COLOR_TYPE_GRAY ||
+         load_png_color_type == PNG_COLOR_TYPE_GRAY_ALPHA) &&
+        (png_color_type == PNG_COLOR_TYPE_RGB || png_color_type == PNG_COLOR_TYPE_RGB_ALPHA ||
+         png_color_type == PNG_COLOR_TYPE_PALETTE))
+    {
+      // negative weights causes default calculation to be used  ((6969 * R + 23434 * G + 2365 *
+      // B)/32768)
+      png_set_rgb_to_gray_fixed(
+          png_ptr, 1, -1.0,
+          -1.0);  // error action 1 causes no waring warning if image was not actually gray
+    }
+    if ((load_png_color_type == PNG_COLOR_TYPE_RGB || load_png_color_type == PNG_COLOR_TYPE_RGBA) &&
+        (png_color_type == PNG_COLOR_TYPE_GRAY || png_color_type == PNG_COLOR_TYPE_GRAY_ALPHA))
+    {
+      png_set_gray_to_rgb(png_ptr);
+    }
+  }
+
+  // Get the exponent of the power function that decodes the samples of an image to linear light,
+  // or 0 if the image is sRGB. Images without color space information are assumed to be sRGB.
+  static double pngwFileGamma(png_structp png_ptr, png_infop info_ptr)
+  {
+    double file_gamma;
+    if (png_get_valid(png_ptr, info_ptr, PNG_INFO_sRGB) == 0 &&
+        png_get_gAMA(png_ptr, info_ptr, &file_gamma) != 0 && file_gamma > 0.0)
+    {
+      return 1.0 / file_gamma;
+    }
+    return 0.0;
+  }
+
+// Entries of the tables used to convert 16 bit samples to linear light. Entry i holds the value of
+// sample i * 64, and samples between entries are interpolated.
+#    define PNGW_LINEAR_TABLE_16_SIZE 1025
+
+  // sRGB encoded 8 bit samples converted to linear light.
+  static const float PNGW_SRGB_LINEAR_8[256] = {
+      0.0f, 0.000303526991f, 0.000607053982f, 0.000910580973f, 0.00121410796f, 0.00151763496f,
+      0.00182116195f, 0.00212468882f, 0.00242821593f, 0.0027317428f, 0.00303526991f, 0.00334653584f,
+      0.00367650739f, 0.00402471703f, 0.00439144205f, 0.00477695325f, 0.00518151652f,
+      0.00560539169f, 0.00604883302f, 0.00651209056f, 0.00699541019f, 0.00749903219f,
+      0.00802319311f, 0.00856812578f, 0.00913405884f, 0.00972121768f, 0.010329823f, 0.0109600937f,
+      0.0116122449f, 0.012286488f, 0.0129830325f, 0.0137020834f, 0.0144438436f, 0.0152085144f,
+      0.0159962941f, 0.0168073755f, 0.0176419541f, 0.01850022f, 0.0193823613f, 0.0202885624f,
+      0.0212190095f, 0.0221738853f, 0.0231533665f, 0.0241576321f, 0.0251868591f, 0.0262412224f,
+      0.0273208916f, 0.02842604f, 0.0295568351f, 0.0307134446f, 0.0318960324f, 0.0331047662f,
+      0.0343398079f, 0.0356013142f, 0.0368894488f, 0.0382043719f, 0.0395462364f, 0.0409151986f,
+      0.0423114114f, 0.043735031f, 0.045186203f, 0.0466650873f, 0.0481718257f, 0.0497065671f,
+      0.0512694567f, 0.0528606474f, 0.054480277f, 0.0561284907f, 0.0578054301f, 0.0595112368f,
+      0.0612460524f, 0.0630100146f, 0.064803265f, 0.0666259378f, 0.0684781671f, 0.0703600943f,
+      0.0722718537f, 0.0742135718f, 0.0761853829f, 0.078187421f, 0.0802198201f, 0.0822827071f,
+      0.0843762085f, 0.0865004584f, 0.0886555836f, 0.0908417106f, 0.0930589661f, 0.0953074694f,
+      0.097587347f, 0.0998987257f, 0.102241732f, 0.104616486f, 0.107023105f, 0.10946171f,
+      0.111932427f, 0.114435375f, 0.116970666f, 0.119538426f, 0.122138776f, 0.124771819f,
+      0.127437681f, 0.130136475f, 0.13286832f, 0.135633335f, 0.138431609f, 0.141263291f,
+      0.144128472f, 0.147027269f, 0.149959788f, 0.152926147f, 0.155926466f, 0.158960834f,
+      0.162029371f, 0.165132195f, 0.168269396f, 0.171441108f, 0.174647406f, 0.177888423f,
+      0.18116425f, 0.18447499f, 0.187820777f, 0.191201687f, 0.194617838f, 0.198069319f, 0.20155625f,
+      0.205078736f, 0.208636865f, 0.212230757f, 0.215860501f, 0.219526201f, 0.223227963f,
+      0.226965874f, 0.230740055f, 0.23455058f, 0.238397568f, 0.242281124f, 0.246201321f,
+      0.25015828f, 0.254152089f, 0.258182853f, 0.262250662f, 0.266355604f, 0.270497799f,
+      0.274677306f, 0.278894275f, 0.283148736f, 0.287440836f, 0.291770637f, 0.296138257f,
+      0.300543785f, 0.304987311f, 0.309468925f, 0.313988715f, 0.318546772f, 0.323143214f,
+      0.327778101f, 0.332451522f, 0.337163627f, 0.341914415f, 0.346704066f, 0.351532608f,
+      0.356400132f, 0.361306787f, 0.366252601f, 0.371237695f, 0.376262128f, 0.38132602f,
+      0.386429429f, 0.391572475f, 0.396755219f, 0.401977777f, 0.407240212f, 0.412542611f,
+      0.417885065f, 0.423267663f, 0.428690493f, 0.434153646f, 0.439657182f, 0.445201188f,
+      0.450785786f, 0.456411034f, 0.462076992f, 0.467783809f, 0.473531485f, 0.479320168f,
+      0.48514995f, 0.491020858f, 0.496932983f, 0.502886474f, 0.50888133f, 0.514917672f,
+      0.520995557f, 0.527115107f, 0.533276379f, 0.539479494f, 0.545724452f, 0.55201143f,
+      0.558340371f, 0.564711511f, 0.571124852f, 0.577580452f, 0.584078431f, 0.590618849f,
+      0.597201765f, 0.603827357f, 0.610495567f, 0.617206573f, 0.623960376f, 0.630757153f,
+      0.637596846f, 0.644479692f, 0.651405632f, 0.658374846f, 0.665387273f, 0.672443151f,
+      0.679542482f, 0.686685324f, 0.693871737f, 0.701101899f, 0.708375752f, 0.715693474f,
+      0.723055124f, 0.730460763f, 0.73791039f, 0.745404184f, 0.752942204f, 0.760524511f,
+      0.768151164f, 0.775822222f, 0.783537805f, 0.791297913f, 0.799102724f, 0.806952238f,
+      0.814846575f, 0.822785735f, 0.830769897f, 0.838799f, 0.846873224f, 0.854992628f, 0.863157213f,
+      0.871367097f, 0.8796224f, 0.887923121f, 0.896269381f, 0.904661179f, 0.913098633f,
+      0.921581864f, 0.930110872f, 0.938685715f, 0.947306514f, 0.955973327f, 0.964686275f,
+      0.973445296f, 0.982250571f, 0.991102099f, 1.0f};
+
+  // sRGB encoded 16 bit samples converted to linear light.
+  static const float PNGW_SRGB_LINEAR_16[PNGW_LINEAR_TABLE_16_SIZE] = {
+      0.0f, 7.55864894e-05f, 0.000151172979f, 0.000226759454f, 0.000302345958f, 0.000377932418f,
+      0.000453518907f, 0.000529105426f, 0.000604691915f, 0.000680278405f, 0.000755864836f,
+      0.000831451325f, 0.000907037815f, 0.000982624362f, 0.00105821085f, 0.00113379734f,
+      0.00120938383f, 0.00128497032f, 0.00136055681f, 0.00143614318f, 0.00151172967f,
+      0.00158731616f, 0.00166290265f, 0.00173848914f, 0.00181407563f, 0.00188966212f,
+      0.00196524872f, 0.0020408351f, 0.0021164217f, 0.00219200808f, 0.00226759468f, 0.00234318106f,
+      0.00241876766f, 0.00249435403f, 0.00256994064f, 0.00264552701f, 0.00272111362f,
+      0.00279669999f, 0.00287228636f, 0.00294787297f, 0.00302345934f, 0.00309904595f,
+      0.00317556853f, 0.00325363781f, 0.00333281513f, 0.00341310538f, 0.00349451276f,
+      0.00357704167f, 0.00366069633f, 0.00374548137f, 0.003831401f, 0.00391845964f, 0.00400666101f,
+      0.00409600977f, 0.00418651057f, 0.00427816715f, 0.00437098322f, 0.00446496392f,
+      0.00456011295f, 0.00465643406f, 0.00475393189f, 0.00485261017f, 0.0049524731f, 0.00505352439f,
+      0.00515576871f, 0.00525920978f, 0.00536385132f, 0.00546969706f, 0.00557675166f,
+      0.00568501838f, 0.00579450186f, 0.00590520492f, 0.0060171322f, 0.00613028742f, 0.00624467432f,
+      0.00636029663f, 0.00647715852f, 0.00659526279f, 0.00671461457f, 0.00683521619f, 0.0069570723f,
+      0.00708018616f, 0.00720456196f, 0.00733020296f, 0.00745711243f, 0.00758529501f, 0.0077147535f,
+      0.0078454921f, 0.0079775136f, 0.00811082218f, 0.00824542157f, 0.00838131458f, 0.00851850491f,
+      0.00865699723f, 0.00879679341f, 0.00893789809f, 0.00908031408f, 0.00922404509f,
+      0.00936909486f, 0.00951546617f, 0.00966316275f, 0.00981218833f, 0.00996254571f, 0.0101142386f,
+      0.0102672707f, 0.0104216449f, 0.0105773648f, 0.0107344333f, 0.0108928541f, 0.0110526299f,
+      0.0112137655f, 0.0113762626f, 0.0115401251f, 0.0117053567f, 0.0118719591f, 0.012039938f,
+      0.0122092944f, 0.0123800319f, 0.0125521552f, 0.0127256652f, 0.0129005676f, 0.0130768633f,
+      0.0132545568f, 0.0134336511f, 0.0136141488f, 0.0137960538f, 0.0139793679f, 0.0141640957f,
+      0.0143502392f, 0.0145378029f, 0.0147267878f, 0.0149171986f, 0.015109038f, 0.0153023088f,
+      0.0154970139f, 0.015693156f, 0.0158907399f, 0.0160897672f, 0.01629024f, 0.0164921638f,
+      0.0166955385f, 0.0169003699f, 0.0171066597f, 0.0173144117f, 0.0175236259f, 0.0177343097f,
+      0.0179464612f, 0.018160088f, 0.01837519f, 0.0185917709f, 0.0188098345f, 0.0190293808f,
+      0.0192504171f, 0.0194729418f, 0.0196969602f, 0.0199224763f, 0.0201494899f, 0.0203780066f,
+      0.0206080265f, 0.0208395552f, 0.0210725926f, 0.0213071443f, 0.0215432122f, 0.0217807982f,
+      0.022019906f, 0.0222605374f, 0.0225026961f, 0.0227463841f, 0.0229916051f, 0.0232383627f,
+      0.0234866571f, 0.0237364918f, 0.0239878688f, 0.0242407937f, 0.0244952664f, 0.0247512925f,
+      0.0250088703f, 0.0252680071f, 0.0255287029f, 0.0257909596f, 0.0260547828f, 0.0263201743f,
+      0.0265871342f, 0.0268556681f, 0.0271257758f, 0.0273974631f, 0.0276707318f, 0.0279455818f,
+      0.0282220189f, 0.0285000447f, 0.0287796613f, 0.0290608723f, 0.0293436795f, 0.0296280868f,
+      0.0299140941f, 0.0302017052f, 0.0304909237f, 0.0307817515f, 0.0310741905f, 0.0313682444f,
+      0.0316639133f, 0.0319612026f, 0.0322601162f, 0.0325606503f, 0.0328628123f, 0.033166606f,
+      0.0334720314f, 0.0337790884f, 0.0340877846f, 0.0343981199f, 0.0347100981f, 0.0350237191f,
+      0.0353389867f, 0.0356559008f, 0.0359744728f, 0.036294695f, 0.036616575f, 0.0369401127f,
+      0.0372653119f, 0.0375921763f, 0.037920706f, 0.0382509083f, 0.0385827757f, 0.0389163196f,
+      0.0392515399f, 0.0395884402f, 0.0399270169f, 0.0402672812f, 0.0406092294f, 0.040952865f,
+      0.041298192f, 0.0416452102f, 0.0419939235f, 0.0423443355f, 0.0426964462f, 0.0430502594f,
+      0.043405775f, 0.0437630005f, 0.0441219322f, 0.0444825776f, 0.0448449366f, 0.0452090092f,
+      0.0455748029f, 0.045942314f, 0.0463115536f, 0.0466825143f, 0.0470552035f, 0.0474296212f,
+      0.047805775f, 0.048183661f, 0.0485632829f, 0.0489446446f, 0.049327746f, 0.0497125909f,
+      0.0500991866f, 0.0504875258f, 0.0508776158f, 0.0512694567f, 0.051663056f, 0.0520584099f,
+      0.0524555258f, 0.0528544001f, 0.0532550402f, 0.0536574461f, 0.0540616177f, 0.0544675626f,
+      0.054875277f, 0.0552847683f, 0.0556960367f, 0.0561090857f, 0.0565239117f, 0.0569405258f,
+      0.0573589243f, 0.057779111f, 0.0582010858f, 0.0586248524f, 0.0590504147f, 0.0594777763f,
+      0.0599069335f, 0.0603378937f, 0.0607706532f, 0.0612052195f, 0.0616415963f, 0.0620797798f,
+      0.0625197738f, 0.0629615858f, 0.0634052083f, 0.0638506562f, 0.0642979145f, 0.0647470057f,
+      0.0651979148f, 0.0656506494f, 0.0661052167f, 0.0665616095f, 0.0670198426f, 0.067479901f,
+      0.0679418072f, 0.0684055462f, 0.0688711256f, 0.0693385527f, 0.06980782f, 0.0702789351f,
+      0.0707519054f, 0.0712267235f, 0.0717033893f, 0.0721819177f, 0.0726623088f, 0.0731445476f,
+      0.0736286566f, 0.0741146281f, 0.0746024624f, 0.0750921667f, 0.0755837411f, 0.076077193f,
+      0.0765725076f, 0.0770697072f, 0.0775687844f, 0.078069739f, 0.0785725787f, 0.079077296f,
+      0.0795839056f, 0.0800924003f, 0.0806027874f, 0.081115067f, 0.081629239f, 0.0821453109f,
+      0.0826632753f, 0.0831831396f, 0.0837049112f, 0.0842285827f, 0.0847541615f, 0.0852816552f,
+      0.0858110487f, 0.0863423645f, 0.0868755877f, 0.0874107257f, 0.0879477859f, 0.0884867609f,
+      0.0890276581f, 0.0895704851f, 0.0901152343f, 0.0906619132f, 0.0912105218f, 0.0917610601f,
+      0.0923135281f, 0.0928679407f, 0.093424283f, 0.0939825699f, 0.0945427939f, 0.0951049626f,
+      0.0956690758f, 0.0962351337f, 0.0968031511f, 0.0973731056f, 0.0979450196f, 0.0985188931f,
+      0.0990947187f, 0.0996724963f, 0.100252241f, 0.100833952f, 0.101417623f, 0.102003254f,
+      0.102590859f, 0.103180438f, 0.103771985f, 0.104365498f, 0.104960993f, 0.10555847f,
+      0.106157921f, 0.106759354f, 0.10736277f, 0.107968166f, 0.108575553f, 0.109184936f,
+      0.109796301f, 0.110409655f, 0.111025013f, 0.111642361f, 0.112261705f, 0.112883054f,
+      0.113506399f, 0.114131749f, 0.114759102f, 0.115388468f, 0.116019838f, 0.116653219f,
+      0.117288619f, 0.117926024f, 0.118565455f, 0.119206898f, 0.11985036f, 0.120495841f,
+      0.121143349f, 0.121792883f, 0.122444443f, 0.123098031f, 0.123753652f, 0.124411307f,
+      0.125070989f, 0.125732705f, 0.126396477f, 0.127062276f, 0.127730116f, 0.128399998f,
+      0.129071921f, 0.129745901f, 0.130421922f, 0.131099999f, 0.131780118f, 0.132462308f,
+      0.133146539f, 0.133832827f, 0.134521186f, 0.135211602f, 0.135904074f, 0.136598617f,
+      0.137295216f, 0.137993887f, 0.138694629f, 0.139397457f, 0.140102342f, 0.140809298f,
+      0.14151834f, 0.142229453f, 0.142942652f, 0.143657938f, 0.144375294f, 0.145094752f,
+      0.145816281f, 0.146539912f, 0.147265628f, 0.14799343f, 0.148723334f, 0.149455324f,
+      0.150189415f, 0.150925606f, 0.151663899f, 0.152404308f, 0.153146803f, 0.153891414f,
+      0.154638126f, 0.15538694f, 0.156137884f, 0.156890929f, 0.15764609f, 0.158403367f, 0.15916276f,
+      0.159924269f, 0.160687909f, 0.161453664f, 0.162221551f, 0.162991554f, 0.163763687f,
+      0.164537951f, 0.165314347f, 0.166092888f, 0.166873544f, 0.167656347f, 0.168441296f,
+      0.16922836f, 0.170017585f, 0.170808941f, 0.171602458f, 0.172398105f, 0.173195913f,
+      0.173995867f, 0.174797967f, 0.175602213f, 0.176408619f, 0.177217185f, 0.178027913f,
+      0.178840801f, 0.179655835f, 0.180473045f, 0.181292415f, 0.182113945f, 0.182937652f,
+      0.183763519f, 0.184591576f, 0.18542178f, 0.186254174f, 0.187088743f, 0.187925488f,
+      0.188764408f, 0.189605504f, 0.190448791f, 0.191294268f, 0.19214192f, 0.192991763f,
+      0.193843782f, 0.194698006f, 0.19555442f, 0.196413025f, 0.197273821f, 0.198136821f,
+      0.199002013f, 0.199869409f, 0.200739011f, 0.201610804f, 0.202484816f, 0.203361019f,
+      0.204239443f, 0.205120072f, 0.206002906f, 0.20688796f, 0.20777522f, 0.2086647f, 0.209556401f,
+      0.210450321f, 0.211346447f, 0.212244809f, 0.21314539f, 0.214048207f, 0.214953244f,
+      0.215860501f, 0.216769993f, 0.217681721f, 0.218595669f, 0.219511867f, 0.2204303f,
+      0.221350953f, 0.222273871f, 0.22319901f, 0.224126399f, 0.225056037f, 0.225987911f,
+      0.226922035f, 0.227858409f, 0.228797033f, 0.229737908f, 0.230681032f, 0.231626406f,
+      0.232574046f, 0.23352395f, 0.234476104f, 0.235430509f, 0.236387193f, 0.237346143f,
+      0.238307342f, 0.239270821f, 0.240236565f, 0.241204575f, 0.242174864f, 0.243147418f,
+      0.244122252f, 0.245099351f, 0.246078745f, 0.247060403f, 0.248044357f, 0.249030575f,
+      0.250019103f, 0.251009881f, 0.252002984f, 0.252998352f, 0.253996015f, 0.254995942f,
+      0.255998194f, 0.257002741f, 0.258009583f, 0.259018689f, 0.260030121f, 0.261043876f,
+      0.262059897f, 0.263078243f, 0.264098883f, 0.265121818f, 0.266147077f, 0.267174631f,
+      0.26820451f, 0.269236684f, 0.270271182f, 0.271308005f, 0.272347122f, 0.273388565f,
+      0.274432331f, 0.275478423f, 0.276526839f, 0.277577579f, 0.278630644f, 0.279686034f,
+      0.280743748f, 0.281803787f, 0.28286615f, 0.283930868f, 0.28499791f, 0.286067277f,
+      0.287138999f, 0.288213044f, 0.289289445f, 0.29036817f, 0.291449249f, 0.292532682f,
+      0.293618441f, 0.294706553f, 0.29579702f, 0.296889842f, 0.297984987f, 0.299082518f,
+      0.300182372f, 0.301284611f, 0.302389205f, 0.303496152f, 0.304605454f, 0.305717111f,
+      0.306831151f, 0.307947546f, 0.309066296f, 0.310187429f, 0.311310917f, 0.312436789f,
+      0.313565016f, 0.314695626f, 0.315828621f, 0.316963971f, 0.318101704f, 0.319241822f,
+      0.320384324f, 0.32152918f, 0.32267645f, 0.323826104f, 0.324978143f, 0.326132536f,
+      0.327289343f, 0.328448564f, 0.329610139f, 0.330774128f, 0.331940502f, 0.33310926f,
+      0.334280431f, 0.335453987f, 0.336629957f, 0.337808341f, 0.338989109f, 0.340172291f,
+      0.341357857f, 0.342545837f, 0.343736231f, 0.344929039f, 0.346124262f, 0.347321898f,
+      0.348521918f, 0.349724382f, 0.35092926f, 0.352136552f, 0.353346258f, 0.354558378f,
+      0.355772942f, 0.35698992f, 0.358209312f, 0.359431148f, 0.360655397f, 0.361882091f,
+      0.363111198f, 0.364342749f, 0.365576744f, 0.366813153f, 0.368052006f, 0.369293272f,
+      0.370537013f, 0.371783167f, 0.373031795f, 0.374282837f, 0.375536323f, 0.376792282f,
+      0.378050655f, 0.379311502f, 0.380574763f, 0.381840497f, 0.383108705f, 0.384379327f,
+      0.385652423f, 0.386927992f, 0.388206005f, 0.389486462f, 0.390769392f, 0.392054796f,
+      0.393342644f, 0.394632965f, 0.39592573f, 0.397220999f, 0.398518711f, 0.399818897f,
+      0.401121557f, 0.40242669f, 0.403734297f, 0.405044377f, 0.406356931f, 0.407671988f,
+      0.408989489f, 0.410309494f, 0.411631972f, 0.412956923f, 0.414284378f, 0.415614307f,
+      0.416946739f, 0.418281645f, 0.419619024f, 0.420958906f, 0.422301292f, 0.423646182f,
+      0.424993545f, 0.426343411f, 0.427695751f, 0.429050624f, 0.430408001f, 0.431767851f,
+      0.433130205f, 0.434495091f, 0.435862452f, 0.437232345f, 0.438604742f, 0.439979643f,
+      0.441357046f, 0.442736983f, 0.444119424f, 0.445504367f, 0.446891844f, 0.448281825f,
+      0.449674338f, 0.451069355f, 0.452466905f, 0.453866959f, 0.455269545f, 0.456674665f,
+      0.458082318f, 0.459492505f, 0.460905194f, 0.462320417f, 0.463738173f, 0.465158492f,
+      0.466581315f, 0.46800667f, 0.469434589f, 0.470865011f, 0.472297996f, 0.473733515f,
+      0.475171596f, 0.47661218f, 0.478055328f, 0.479501039f, 0.480949283f, 0.48240006f, 0.4838534f,
+      0.485309303f, 0.486767739f, 0.488228738f, 0.489692301f, 0.491158396f, 0.492627084f,
+      0.494098306f, 0.49557209f, 0.497048438f, 0.498527348f, 0.500008821f, 0.501492858f,
+      0.502979457f, 0.50446862f, 0.505960345f, 0.507454693f, 0.508951545f, 0.510451019f,
+      0.511952996f, 0.513457596f, 0.514964819f, 0.516474545f, 0.517986894f, 0.519501805f,
+      0.52101928f, 0.522539377f, 0.524062037f, 0.52558732f, 0.527115107f, 0.528645575f,
+      0.530178547f, 0.531714141f, 0.533252358f, 0.534793139f, 0.536336541f, 0.537882507f,
+      0.539431036f, 0.540982246f, 0.542535961f, 0.544092357f, 0.545651317f, 0.547212899f,
+      0.548777044f, 0.550343871f, 0.551913202f, 0.553485215f, 0.55505985f, 0.556637049f,
+      0.55821687f, 0.559799314f, 0.56138432f, 0.562972009f, 0.564562261f, 0.566155195f,
+      0.567750692f, 0.569348812f, 0.570949614f, 0.572552979f, 0.574158967f, 0.575767577f,
+      0.577378869f, 0.578992724f, 0.580609262f, 0.582228363f, 0.583850145f, 0.585474551f,
+      0.587101579f, 0.588731229f, 0.590363562f, 0.591998518f, 0.593636096f, 0.595276296f,
+      0.596919179f, 0.598564684f, 0.600212812f, 0.601863563f, 0.603516996f, 0.605173111f,
+      0.606831849f, 0.608493209f, 0.610157251f, 0.611823916f, 0.613493264f, 0.615165234f,
+      0.616839886f, 0.61851716f, 0.620197117f, 0.621879756f, 0.623565018f, 0.625252962f,
+      0.626943529f, 0.628636837f, 0.630332768f, 0.632031322f, 0.633732617f, 0.635436535f,
+      0.637143135f, 0.638852358f, 0.640564322f, 0.64227891f, 0.643996239f, 0.64571619f,
+      0.647438824f, 0.64916414f, 0.650892138f, 0.652622819f, 0.654356182f, 0.656092167f,
+      0.657830894f, 0.659572303f, 0.661316395f, 0.663063169f, 0.664812684f, 0.666564822f,
+      0.668319702f, 0.670077205f, 0.671837449f, 0.673600376f, 0.675365984f, 0.677134335f,
+      0.678905368f, 0.680679083f, 0.68245548f, 0.684234619f, 0.68601644f, 0.687800944f,
+      0.689588189f, 0.691378117f, 0.693170786f, 0.694966137f, 0.696764171f, 0.698564947f,
+      0.700368464f, 0.702174664f, 0.703983545f, 0.705795169f, 0.707609534f, 0.709426582f,
+      0.711246371f, 0.713068902f, 0.714894116f, 0.716722071f, 0.718552709f, 0.720386147f,
+      0.722222269f, 0.724061072f, 0.725902677f, 0.727746964f, 0.729593992f, 0.731443763f,
+      0.733296275f, 0.735151529f, 0.737009466f, 0.738870203f, 0.740733624f, 0.742599785f,
+      0.744468749f, 0.746340394f, 0.748214781f, 0.75009191f, 0.751971841f, 0.753854454f,
+      0.755739868f, 0.757627964f, 0.759518862f, 0.761412501f, 0.763308883f, 0.765208006f,
+      0.767109871f, 0.769014537f, 0.770921946f, 0.772832096f, 0.774744987f, 0.776660681f,
+      0.778579116f, 0.780500293f, 0.782424271f, 0.784350991f, 0.786280453f, 0.788212717f,
+      0.790147722f, 0.792085528f, 0.794026077f, 0.795969367f, 0.797915459f, 0.799864352f,
+      0.801815987f, 0.803770423f, 0.805727601f, 0.807687581f, 0.809650302f, 0.811615825f,
+      0.813584149f, 0.815555274f, 0.817529142f, 0.819505811f, 0.821485221f, 0.823467433f,
+      0.825452507f, 0.827440262f, 0.829430878f, 0.831424236f, 0.833420455f, 0.835419416f,
+      0.837421179f, 0.839425743f, 0.841433108f, 0.843443274f, 0.845456183f, 0.847471952f,
+      0.849490523f, 0.851511836f, 0.85353601f, 0.855562985f, 0.857592762f, 0.85962534f,
+      0.861660719f, 0.8636989f, 0.865739882f, 0.867783666f, 0.86983031f, 0.871879756f, 0.873932004f,
+      0.875987053f, 0.878044903f, 0.880105615f, 0.882169127f, 0.884235501f, 0.886304617f,
+      0.888376594f, 0.890451431f, 0.892529011f, 0.894609451f, 0.896692753f, 0.898778856f,
+      0.90086776f, 0.902959526f, 0.905054152f, 0.90715152f, 0.909251809f, 0.911354899f,
+      0.913460791f, 0.915569544f, 0.917681158f, 0.919795573f, 0.921912849f, 0.924032986f,
+      0.926155925f, 0.928281724f, 0.930410385f, 0.932541847f, 0.93467617f, 0.936813354f, 0.9389534f,
+      0.941096246f, 0.943242013f, 0.945390582f, 0.947542012f, 0.949696243f, 0.951853395f,
+      0.954013407f, 0.956176221f, 0.958341956f, 0.960510492f, 0.962681949f, 0.964856207f,
+      0.967033386f, 0.969213367f, 0.971396267f, 0.97358197f, 0.975770593f, 0.977962077f,
+      0.980156422f, 0.982353628f, 0.984553695f, 0.986756623f, 0.988962471f, 0.991171181f,
+      0.993382752f, 0.995597184f, 0.997814536f, 1.00003469f};
+
+  // Fill a table for converting 8 bit (256 entries) or 16 bit (PNGW_LINEAR_TABLE_16_SIZE entries)
+  // samples that are encoded with a power function to linear light. sRGB images use the constant
+  // tables above instead.
+  static void pngwFillLinearTable(float* const table, const size_t load_depth, const double gamma)
+  {
+    if (load_depth == 8)
+    {
+      for (size_t i = 0; i < 256; i++)
+      {
+        table[i] = (float)pow((double)i / 255.0, gamma);
+      }
+    }
+    else
+    {
+      for (size_t i = 0; i < PNGW_LINEAR_TABLE_16_SIZE; i++)
+      {
+        table[i] = (float)pow((double)(i * 64) / 65535.0, gamma);
+      }
+    }
+  }
+
+  // Convert a native byte order 16 bit sample to linear light using a 16 bit table.
+  static float pngwLinearFromSample16(const float* const table, const pngwb_t* const sample)
+  {
+    pngws_t value;
+    memcpy(&value, sample, 2);
+    const float t = (float)(value & 0x3f) / 64.0f;
+    return table[value >> 6] + (table[(value >> 6) + 1] - table[value >> 6]) * t;
+  }
+
+  // Convert a native byte order 16 bit alpha sample to a float.
+  static float pngwAlphaFromSample16(const pngwb_t* const sample)
+  {
+    pngws_t value;
+    memcpy(&value, sample, 2);
+    return (float)value / 65535.0f;
+  }
+
+  static void pngwStoreFloat32(pngwb_t* const row, const size_t i, const float value)
+  {
+    memcpy(&row[i * 4], &value, 4);
+  }
+
+  static void pngwStoreFloat16(pngwb_t* const row, const size_t i, const float value)
+  {
+    const pngws_t half = pngwFloatToHalf(value);
+    memcpy(&row[i * 2], &half, 2);
+  }
+
+  // Convert a row of 8 or 16 bit samples that ends at the end of the row into floating point
+  // samples that fill the whole row. Samples are converted from first to last, so each sample is
+  // read before its bytes are overwritten. There is a loop for each combination of depths, and the
+  // color and alpha samples of each pixel are converted by separate loops over the channels, so
+  // that nothing is decided per sample.
+  static void pngwConvertRowToFloat(pngwb_t* const row, const size_t width, const pngwcolor_t color,
+                                    const size_t depth, const size_t load_depth,
+                                    const float* const table)
+  {
+    const size_t channels = (size_t)color;
+    const size_t color_channels =
+        (color == PNGW_COLOR_GA || color == PNGW_COLOR_RGBA) ? channels - 1 : channels;
+    const size_t count = width * channels;
+    const pngwb_t* const source = row + count * (pngwSampleSize(depth) - load_depth / 8);
+    if (load_depth == 8 && depth == PNGW_DEPTH_FLOAT32)
+    {
+      for (size_t i = 0; i < count; i += channels)
+      {
+        for (size_t c = i; c < i + color_channels; c++)
+        {
+          pngwStoreFloat32(row, c, table[source[c]]);
+        }
+        for (size_t c = i + color_channels; c < i + channels; c++)
+        {
+          pngwStoreFloat32(row, c, (float)source[c] / 255.0f);
+        }
+      }
+    }
+    else if (load_depth == 8)
+    {
+      for (size_t i = 0; i < count; i += channels)
+      {
+        for (size_t c = i; c < i + color_channels; c++)
+        {
+          pngwStoreFloat16(row, c, table[source[c]]);
+        }
+        for (size_t c = i + color_channels; c < i + channels; c++)
+        {
+          pngwStoreFloat16(row, c, (float)source[c] / 255.0f);
+        }
+      }
+    }
+    else if (depth == PNGW_DEPTH_FLOAT32)
+    {
+      for (size_t i = 0; i < count; i += channels)
+      {
+        for (size_t c = i; c < i + color_channels; c++)
+        {
+          pngwStoreFloat32(row, c, pngwLinearFromSample16(table, &source[c * 2]));
+        }
+        for (size_t c = i + color_channels; c < i + channels; c++)
+        {
+          pngwStoreFloat32(row, c, pngwAlphaFromSample16(&source[c * 2]));
+        }
+      }
+    }
+    else
+    {
+      for (size_t i = 0; i < count; i += channels)
+      {
+        for (size_t c = i; c < i + color_channels; c++)
+        {
+          pngwStoreFloat16(row, c, pngwLinearFromSample16(table, &source[c * 2]));
+        }
+        for (size_t c = i + color_channels; c < i + channels; c++)
+        {
+          pngwStoreFloat16(row, c, pngwAlphaFromSample16(&source[c * 2]));
+        }
+      }
+    }
+  }
+
+  static float pngwLoadFloat32(const pngwb_t* const source, const size_t i)
+  {
+    float value;
+    memcpy(&value, &source[i * 4], 4);
+    return value;
+  }
+
+  static float pngwLoadFloat16(const pngwb_t* const source, const size_t i)
+  {
+    pngws_t half;
+    memcpy(&half, &source[i * 2], 2);
+    return pngwHalfToFloat(half);
+  }
+
+// Entries of the table used to encode linear light samples as sRGB. Samples from 2^-9 to 1 are
+// split into 9 octaves of 128 entries, so entry i holds the value of sample
+// 2^(i / 128 - 9) * (1 + (i % 128) / 128). An entry is found from the exponent and the top 7
+// mantissa bits of a sample, and samples between entries are interpolated. Smaller samples are on
+// the straight part of the sRGB curve and are encoded without the table.
+#    define PNGW_SRGB_ENCODE_TABLE_SIZE (9 * 128 + 1)
+
+  // Linear light samples from 2^-9 to 1 encoded as sRGB, in the layout described by
+  // PNGW_SRGB_ENCODE_TABLE_SIZE.
+  static const float PNGW_SRGB_ENCODED[PNGW_SRGB_ENCODE_TABLE_SIZE] = {
+      0.0252343751f, 0.0254315194f, 0.0256286617f, 0.025825806f, 0.0260229483f, 0.0262200925f,
+      0.0264172368f, 0.0266143791f, 0.0268115234f, 0.0270086676f, 0.02720581f, 0.0274029542f,
+      0.0276000984f, 0.0277972408f, 0.027994385f, 0.0281915292f, 0.0283886716f, 0.0285858158f,
+      0.0287829582f, 0.0289801024f, 0.0291772466f, 0.029374389f, 0.0295715332f, 0.0297686774f,
+      0.0299658198f, 0.030162964f, 0.0303601082f, 0.0305572506f, 0.0307543948f, 0.0309515372f,
+      0.0311486814f, 0.0313458256f, 0.031542968f, 0.0317401141f, 0.0319372565f, 0.0321343988f,
+      0.0323315412f, 0.0325286873f, 0.0327258296f, 0.032922972f, 0.0331201181f, 0.0333172604f,
+      0.0335144028f, 0.0337115489f, 0.0339086913f, 0.0341058336f, 0.0343029797f, 0.0345001221f,
+      0.0346972644f, 0.0348944105f, 0.0350915529f, 0.0352886952f, 0.0354858413f, 0.0356829837f,
+      0.0358801261f, 0.0360772721f, 0.0362744145f, 0.0364715569f, 0.036668703f, 0.0368658453f,
+      0.0370629877f, 0.03726013f, 0.0374572761f, 0.0376544185f, 0.0378515609f, 0.0380487069f,
+      0.0382458493f, 0.0384429917f, 0.0386401378f, 0.0388372801f, 0.0390344225f, 0.0392315686f,
+      0.0394287109f, 0.0396258533f, 0.0398229994f, 0.0400201418f, 0.0402172841f, 0.0404144302f,
+      0.0406086445f, 0.0408017561f, 0.0409943201f, 0.0411863476f, 0.0413778424f, 0.0415688008f,
+      0.0417592376f, 0.0419491455f, 0.0421385393f, 0.0423274115f, 0.0425157771f, 0.0427036323f,
+      0.0428909846f, 0.043077834f, 0.0432641879f, 0.0434500501f, 0.0436354205f, 0.0438203029f,
+      0.0440047048f, 0.0441886261f, 0.0443720706f, 0.0445550419f, 0.0447375439f, 0.0449195802f,
+      0.0451011546f, 0.045282267f, 0.045462925f, 0.0456431285f, 0.0458228774f, 0.0460021831f,
+      0.0461810455f, 0.0463594608f, 0.046537444f, 0.0467149876f, 0.0468920991f, 0.0470687784f,
+      0.0472450331f, 0.0474208631f, 0.0475962721f, 0.0477712639f, 0.0479458347f, 0.0481199957f,
+      0.0482937433f, 0.0484670848f, 0.0486400202f, 0.0488125533f, 0.0489846841f, 0.0491564199f,
+      0.0493277572f, 0.0494987033f, 0.0496692583f, 0.0500092022f, 0.0503476188f, 0.0506845154f,
+      0.0510199182f, 0.0513538383f, 0.0516862981f, 0.0520173162f, 0.0523469076f, 0.0526750833f,
+      0.0530018695f, 0.0533272736f, 0.053651318f, 0.0539740138f, 0.0542953797f, 0.0546154231f,
+      0.0549341664f, 0.0552516207f, 0.055567801f, 0.0558827221f, 0.0561963916f, 0.0565088317f,
+      0.0568200499f, 0.0571300574f, 0.0574388728f, 0.0577465035f, 0.0580529645f, 0.0583582669f,
+      0.058662422f, 0.0589654408f, 0.0592673384f, 0.059568122f, 0.059867803f, 0.0601663925f,
+      0.0604639053f, 0.060760349f, 0.061055731f, 0.0613500662f, 0.061643362f, 0.061935626f,
+      0.0622268766f, 0.062517114f, 0.062806353f, 0.063094601f, 0.0633818656f, 0.0636681542f,
+      0.0639534891f, 0.0642378628f, 0.0645212904f, 0.0648037791f, 0.0650853366f, 0.0653659776f,
+      0.0656457022f, 0.0659245253f, 0.0662024468f, 0.0664794818f, 0.0667556375f, 0.0670309141f,
+      0.0673053265f, 0.067578882f, 0.0678515807f, 0.0681234375f, 0.0683944598f, 0.0686646476f,
+      0.0689340085f, 0.0692025572f, 0.0694702938f, 0.0697372258f, 0.0700033605f, 0.0702687055f,
+      0.0705332607f, 0.0707970411f, 0.071060054f, 0.0713222995f, 0.0715837777f, 0.0718445107f,
+      0.0721044913f, 0.0723637268f, 0.0726222321f, 0.0728799999f, 0.0731370449f, 0.0733933747f,
+      0.0736489818f, 0.0739038885f, 0.0741580874f, 0.0744115859f, 0.0746643916f, 0.0749165118f,
+      0.0751679465f, 0.0754187033f, 0.0756687894f, 0.0759182051f, 0.0761669576f, 0.076415047f,
+      0.0766624883f, 0.0769092813f, 0.0771554261f, 0.0774009302f, 0.077645801f, 0.0778900385f,
+      0.0781336501f, 0.0783766359f, 0.0786190107f, 0.0788607672f, 0.0791019127f, 0.0793424547f,
+      0.0795824006f, 0.0798217431f, 0.0800604895f, 0.0802986473f, 0.0805362239f, 0.0807732195f,
+      0.0810096338f, 0.0812454745f, 0.081480749f, 0.0817154497f, 0.0819495916f, 0.0821831748f,
+      0.0824162066f, 0.0826486796f, 0.0828806087f, 0.0831119865f, 0.0833428279f, 0.0835731328f,
+      0.0838029012f, 0.0840321407f, 0.0842608511f, 0.0844890326f, 0.0847166926f, 0.0851704702f,
+      0.0856221989f, 0.086071901f, 0.0865196064f, 0.0869653448f, 0.0874091238f, 0.0878509805f,
+      0.0882909298f, 0.0887289941f, 0.0891652033f, 0.0895995647f, 0.0900321081f, 0.090462856f,
+      0.0908918232f, 0.0913190395f, 0.0917445049f, 0.0921682566f, 0.0925903097f, 0.0930106789f,
+      0.0934293792f, 0.0938464329f, 0.0942618549f, 0.0946756676f, 0.0950878859f, 0.0954985246f,
+      0.0959075987f, 0.0963151306f, 0.0967211276f, 0.0971256122f, 0.0975285918f, 0.0979300961f,
+      0.0983301178f, 0.098728694f, 0.0991258249f, 0.0995215252f, 0.0999158174f, 0.100308701f,
+      0.100700207f, 0.101090334f, 0.101479106f, 0.101866528f, 0.10225261f, 0.102637373f,
+      0.103020832f, 0.103402987f, 0.103783853f, 0.104163446f, 0.104541779f, 0.10491886f,
+      0.105294697f, 0.105669305f, 0.106042698f, 0.106414877f, 0.106785864f, 0.107155658f,
+      0.107524276f, 0.107891731f, 0.108258024f, 0.108623177f, 0.10898719f, 0.10935007f,
+      0.109711841f, 0.110072494f, 0.110432051f, 0.110790521f, 0.111147903f, 0.111504219f,
+      0.111859463f, 0.112213656f, 0.112566799f, 0.112918906f, 0.113269985f, 0.113620035f,
+      0.113969073f, 0.114317104f, 0.114664137f, 0.11501018f, 0.115355238f, 0.115699321f,
+      0.116042435f, 0.116384588f, 0.116725788f, 0.117066041f, 0.117405355f, 0.117743738f,
+      0.118081197f, 0.118417732f, 0.118753359f, 0.119088084f, 0.119421907f, 0.119754836f,
+      0.120086879f, 0.120418042f, 0.120748334f, 0.121077761f, 0.121406324f, 0.121734038f,
+      0.122060902f, 0.122386917f, 0.122712106f, 0.123036452f, 0.123359978f, 0.123682685f,
+      0.12400458f, 0.124325663f, 0.124645948f, 0.124965429f, 0.12528412f, 0.125602037f,
+      0.125919148f, 0.1262355f, 0.126551077f, 0.126865894f, 0.127179936f, 0.127493232f,
+      0.127805769f, 0.128117576f, 0.128428623f, 0.12873894f, 0.129048526f, 0.129357383f,
+      0.129665524f, 0.129972935f, 0.130279645f, 0.130585641f, 0.130890936f, 0.131195515f,
+      0.13149941f, 0.132105127f, 0.132708117f, 0.133308396f, 0.133906022f, 0.134500995f,
+      0.135093376f, 0.135683179f, 0.136270449f, 0.136855185f, 0.137437448f, 0.138017267f,
+      0.138594642f, 0.139169618f, 0.139742225f, 0.140312478f, 0.140880421f, 0.141446054f,
+      0.142009422f, 0.142570555f, 0.143129453f, 0.143686146f, 0.144240677f, 0.144793049f,
+      0.145343289f, 0.145891428f, 0.146437481f, 0.146981463f, 0.147523403f, 0.148063332f,
+      0.148601249f, 0.149137184f, 0.149671152f, 0.150203183f, 0.150733292f, 0.151261494f,
+      0.151787803f, 0.152312249f, 0.152834848f, 0.153355598f, 0.153874546f, 0.154391691f,
+      0.154907048f, 0.155420646f, 0.155932501f, 0.156442612f, 0.15695101f, 0.157457709f,
+      0.157962725f, 0.158466071f, 0.158967748f, 0.159467787f, 0.159966201f, 0.160463005f,
+      0.160958216f, 0.161451831f, 0.161943883f, 0.162434369f, 0.162923321f, 0.163410738f,
+      0.163896635f, 0.164381027f, 0.164863929f, 0.165345341f, 0.165825292f, 0.166303799f,
+      0.166780844f, 0.16725646f, 0.167730659f, 0.168203458f, 0.168674842f, 0.169144854f,
+      0.169613481f, 0.170080736f, 0.170546651f, 0.171011224f, 0.171474457f, 0.171936363f,
+      0.172396958f, 0.172856256f, 0.173314258f, 0.173770979f, 0.174226433f, 0.17468062f,
+      0.175133541f, 0.175585225f, 0.176035687f, 0.176484898f, 0.176932916f, 0.177379712f,
+      0.177825317f, 0.178269714f, 0.178712949f, 0.179154992f, 0.179595888f, 0.180035621f,
+      0.180474192f, 0.18091163f, 0.181347951f, 0.181783125f, 0.182217196f, 0.182650149f,
+      0.183082014f, 0.183512777f, 0.183942452f, 0.184371039f, 0.184798568f, 0.185225025f,
+      0.185650438f, 0.186074793f, 0.186498106f, 0.186920375f, 0.187341616f, 0.187761843f,
+      0.188181043f, 0.188599244f, 0.189016432f, 0.189432636f, 0.189847842f, 0.190262064f,
+      0.190675318f, 0.191087589f, 0.191498905f, 0.191909254f, 0.192318648f, 0.192727104f,
+      0.193134621f, 0.193541199f, 0.193946853f, 0.19475539f, 0.195560277f, 0.196361557f,
+      0.197159275f, 0.197953478f, 0.198744208f, 0.19953151f, 0.200315416f, 0.201095954f,
+      0.201873183f, 0.202647135f, 0.203417838f, 0.204185352f, 0.204949677f, 0.205710888f,
+      0.206468984f, 0.207224026f, 0.207976028f, 0.208725035f, 0.209471092f, 0.210214198f,
+      0.210954398f, 0.211691722f, 0.212426215f, 0.213157892f, 0.213886783f, 0.214612916f,
+      0.215336323f, 0.216057032f, 0.21677506f, 0.21749045f, 0.218203217f, 0.218913391f,
+      0.219621003f, 0.220326051f, 0.221028596f, 0.221728653f, 0.222426236f, 0.22312136f,
+      0.22381407f, 0.224504367f, 0.225192308f, 0.225877866f, 0.226561114f, 0.227242038f,
+      0.227920666f, 0.22859703f, 0.229271129f, 0.229943007f, 0.23061268f, 0.231280148f,
+      0.231945455f, 0.232608616f, 0.233269632f, 0.233928531f, 0.234585345f, 0.235240072f,
+      0.235892728f, 0.236543357f, 0.23719196f, 0.237838537f, 0.238483131f, 0.239125758f,
+      0.239766404f, 0.240405127f, 0.241041914f, 0.241676793f, 0.242309764f, 0.242940873f,
+      0.243570104f, 0.244197473f, 0.244823024f, 0.245446742f, 0.246068656f, 0.246688783f,
+      0.247307122f, 0.247923702f, 0.248538524f, 0.249151617f, 0.249762982f, 0.250372618f,
+      0.250980586f, 0.251586825f, 0.252191424f, 0.252794355f, 0.253395647f, 0.25399527f,
+      0.254593283f, 0.255189687f, 0.255784512f, 0.256377727f, 0.256969362f, 0.257559419f,
+      0.258147925f, 0.258734912f, 0.259320349f, 0.259904265f, 0.260486662f, 0.261067569f,
+      0.261646956f, 0.262224883f, 0.262801349f, 0.263376355f, 0.263949901f, 0.264522016f,
+      0.265092701f, 0.265661955f, 0.266229779f, 0.266796231f, 0.267361283f, 0.267924964f,
+      0.268487245f, 0.269048184f, 0.269607753f, 0.27016598f, 0.270722866f, 0.271278411f,
+      0.271832645f, 0.272385567f, 0.272937208f, 0.273487508f, 0.274036556f, 0.274584323f,
+      0.275130808f, 0.275676012f, 0.276219994f, 0.276762694f, 0.277304173f, 0.278383434f,
+      0.279457837f, 0.280527413f, 0.28159225f, 0.282652378f, 0.283707887f, 0.284758806f,
+      0.285805196f, 0.286847085f, 0.287884563f, 0.288917661f, 0.289946437f, 0.290970922f,
+      0.291991204f, 0.293007284f, 0.294019222f, 0.295027077f, 0.296030879f, 0.297030687f,
+      0.298026532f, 0.299018472f, 0.300006539f, 0.300990731f, 0.301971167f, 0.302947849f,
+      0.303920776f, 0.304890066f, 0.305855691f, 0.30681771f, 0.307776183f, 0.308731109f,
+      0.309682548f, 0.3106305f, 0.311575055f, 0.312516183f, 0.313453972f, 0.314388424f,
+      0.315319598f, 0.316247463f, 0.31717214f, 0.318093568f, 0.319011837f, 0.319926977f,
+      0.320838988f, 0.321747899f, 0.32265377f, 0.323556602f, 0.324456424f, 0.325353295f,
+      0.326247185f, 0.327138156f, 0.328026235f, 0.328911453f, 0.329793781f, 0.330673337f,
+      0.331550062f, 0.332424015f, 0.333295226f, 0.334163696f, 0.335029453f, 0.335892558f,
+      0.336752981f, 0.337610781f, 0.338465959f, 0.339318544f, 0.340168536f, 0.341015995f,
+      0.34186092f, 0.342703342f, 0.343543261f, 0.344380707f, 0.345215708f, 0.346048295f,
+      0.346878439f, 0.347706199f, 0.348531604f, 0.349354625f, 0.350175321f, 0.350993693f,
+      0.35180977f, 0.352623552f, 0.353435069f, 0.354244322f, 0.355051368f, 0.35585618f,
+      0.356658787f, 0.357459217f, 0.358257473f, 0.359053582f, 0.359847546f, 0.360639393f,
+      0.361429125f, 0.362216771f, 0.36300236f, 0.363785863f, 0.36456731f, 0.36534676f, 0.366124153f,
+      0.36689958f, 0.36767298f, 0.368444443f, 0.369213909f, 0.369981438f, 0.37074703f, 0.371510714f,
+      0.372272491f, 0.373032331f, 0.373790324f, 0.374546438f, 0.375300705f, 0.376053095f,
+      0.376803666f, 0.37755242f, 0.378299356f, 0.379044503f, 0.379787862f, 0.380529433f,
+      0.381269246f, 0.382007331f, 0.382743627f, 0.383478224f, 0.384211123f, 0.384942263f,
+      0.385671735f, 0.386399537f, 0.387125641f, 0.387850076f, 0.388572872f, 0.390013516f,
+      0.391447663f, 0.392875373f, 0.394296765f, 0.395711869f, 0.397120804f, 0.398523599f,
+      0.399920344f, 0.401311129f, 0.402695984f, 0.404074997f, 0.405448258f, 0.406815797f,
+      0.408177674f, 0.409533978f, 0.410884768f, 0.412230104f, 0.413570017f, 0.414904594f,
+      0.416233897f, 0.417557955f, 0.418876857f, 0.420190632f, 0.421499342f, 0.422803044f,
+      0.42410177f, 0.425395608f, 0.426684558f, 0.427968711f, 0.429248095f, 0.43052277f,
+      0.431792796f, 0.433058172f, 0.43431899f, 0.435575277f, 0.436827064f, 0.43807441f,
+      0.439317346f, 0.44055593f, 0.441790193f, 0.443020165f, 0.444245934f, 0.445467472f,
+      0.446684867f, 0.44789812f, 0.449107319f, 0.450312436f, 0.451513588f, 0.452710718f,
+      0.453903943f, 0.455093235f, 0.456278682f, 0.457460284f, 0.458638102f, 0.459812135f,
+      0.460982412f, 0.462149024f, 0.46331194f, 0.464471221f, 0.465626866f, 0.466778964f,
+      0.467927486f, 0.469072521f, 0.470214039f, 0.4713521f, 0.472486734f, 0.473617941f, 0.47474578f,
+      0.475870281f, 0.476991445f, 0.4781093f, 0.479223907f, 0.480335236f, 0.481443375f,
+      0.482548296f, 0.483650059f, 0.484748691f, 0.485844165f, 0.486936569f, 0.488025874f,
+      0.489112169f, 0.490195394f, 0.491275638f, 0.492352903f, 0.493427187f, 0.494498551f,
+      0.495566994f, 0.496632546f, 0.497695208f, 0.498755038f, 0.499812007f, 0.500866175f,
+      0.501917601f, 0.502966166f, 0.504012048f, 0.505055189f, 0.506095588f, 0.507133305f,
+      0.50816834f, 0.509200752f, 0.510230482f, 0.511257648f, 0.512282193f, 0.513304114f,
+      0.514323473f, 0.515340328f, 0.51635462f, 0.517366409f, 0.518375695f, 0.519382536f,
+      0.520386875f, 0.521388769f, 0.52238822f, 0.523385227f, 0.524379909f, 0.525372148f,
+      0.526362062f, 0.527349591f, 0.528334796f, 0.529317677f, 0.530298233f, 0.531276464f,
+      0.532252491f, 0.533226192f, 0.534197688f, 0.535166919f, 0.536133945f, 0.537098706f,
+      0.53902179f, 0.540936112f, 0.542841911f, 0.544739187f, 0.546628177f, 0.548508823f,
+      0.550381362f, 0.552245796f, 0.554102242f, 0.55595082f, 0.557791591f, 0.559624672f,
+      0.561450124f, 0.563268006f, 0.565078497f, 0.566881537f, 0.568677366f, 0.570465922f,
+      0.572247386f, 0.574021816f, 0.575789213f, 0.577549696f, 0.579303384f, 0.581050336f,
+      0.582790554f, 0.584524155f, 0.586251199f, 0.587971747f, 0.589685917f, 0.59139365f,
+      0.593095183f, 0.594790399f, 0.596479475f, 0.598162472f, 0.599839389f, 0.601510346f,
+      0.603175342f, 0.604834497f, 0.606487811f, 0.608135343f, 0.609777153f, 0.61141336f,
+      0.613043904f, 0.614668965f, 0.616288483f, 0.617902517f, 0.619511187f, 0.621114492f,
+      0.622712493f, 0.624305248f, 0.625892818f, 0.627475142f, 0.629052401f, 0.630624592f,
+      0.632191718f, 0.633753896f, 0.635311127f, 0.63686341f, 0.638410866f, 0.639953494f,
+      0.641491354f, 0.643024445f, 0.644552886f, 0.64607662f, 0.647595763f, 0.649110317f,
+      0.650620282f, 0.652125776f, 0.6536268f, 0.655123353f, 0.656615555f, 0.658103347f,
+      0.659586787f, 0.661065996f, 0.662540913f, 0.664011598f, 0.665478051f, 0.666940331f,
+      0.668398499f, 0.669852614f, 0.671302617f, 0.672748566f, 0.674190521f, 0.675628483f,
+      0.677062452f, 0.678492546f, 0.679918766f, 0.681341112f, 0.682759583f, 0.684174299f,
+      0.685585201f, 0.686992347f, 0.688395798f, 0.689795494f, 0.691191554f, 0.692583978f,
+      0.693972766f, 0.695357978f, 0.696739554f, 0.698117673f, 0.699492216f, 0.700863242f,
+      0.702230871f, 0.703594983f, 0.704955697f, 0.706313014f, 0.707666934f, 0.709017515f,
+      0.710364759f, 0.711708665f, 0.713049293f, 0.714386702f, 0.715720773f, 0.717051685f,
+      0.718379378f, 0.719703913f, 0.721025229f, 0.722343445f, 0.723658502f, 0.72497052f,
+      0.726279378f, 0.727585256f, 0.728888035f, 0.730187774f, 0.731484532f, 0.732778311f,
+      0.734069109f, 0.735356987f, 0.73792392f, 0.74047929f, 0.743023217f, 0.745555818f,
+      0.748077273f, 0.750587642f, 0.753087163f, 0.755575895f, 0.758053958f, 0.760521531f,
+      0.762978673f, 0.765425503f, 0.767862201f, 0.770288825f, 0.772705495f, 0.775112271f,
+      0.777509391f, 0.779896855f, 0.782274842f, 0.784643352f, 0.787002563f, 0.789352596f,
+      0.791693449f, 0.794025302f, 0.796348214f, 0.798662305f, 0.800967634f, 0.80326432f,
+      0.805552423f, 0.807832062f, 0.810103238f, 0.812366128f, 0.814620793f, 0.816867292f,
+      0.819105744f, 0.82133621f, 0.823558688f, 0.825773358f, 0.82798028f, 0.830179513f,
+      0.832371056f, 0.834555089f, 0.836731672f, 0.838900805f, 0.841062605f, 0.843217134f,
+      0.845364451f, 0.847504616f, 0.849637687f, 0.851763725f, 0.853882849f, 0.855995059f,
+      0.858100414f, 0.860199034f, 0.862290919f, 0.864376128f, 0.86645478f, 0.868526876f,
+      0.870592475f, 0.872651637f, 0.874704421f, 0.876750886f, 0.878791034f, 0.880825043f,
+      0.882852793f, 0.884874463f, 0.886890113f, 0.888899684f, 0.890903294f, 0.892901003f,
+      0.894892812f, 0.896878779f, 0.898858964f, 0.900833428f, 0.902802169f, 0.904765308f,
+      0.906722784f, 0.908674777f, 0.910621166f, 0.912562132f, 0.914497674f, 0.916427791f,
+      0.918352544f, 0.920271993f, 0.922186136f, 0.924095094f, 0.925998867f, 0.927897453f,
+      0.929790914f, 0.931679308f, 0.933562636f, 0.935440958f, 0.937314332f, 0.939182699f,
+      0.941046238f, 0.94290489f, 0.944758713f, 0.946607709f, 0.948451936f, 0.950291455f,
+      0.952126265f, 0.953956425f, 0.955781937f, 0.957602799f, 0.959419131f, 0.961230934f,
+      0.963038206f, 0.964841008f, 0.96663934f, 0.968433261f, 0.970222831f, 0.97200799f,
+      0.973788857f, 0.975565374f, 0.977337599f, 0.979105651f, 0.980869412f, 0.982629001f,
+      0.984384418f, 0.986135721f, 0.987882853f, 0.989625931f, 0.991364956f, 0.993099928f,
+      0.994830906f, 0.996557891f, 0.998280942f, 1.0f};
+
+  // Encode a linear light sample that ranges from 0 to 1 as sRGB.
+  static float pngwEncodedFromLinear(const float value)
+  {
+    if (value < 0.001953125f)
+    {
+      return value * 12.92f;
+    }
+    if (value >= 1.0f)
+    {
+      return 1.0f;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    const size_t index = ((size_t)((bits >> 23) - 127 + 9) << 7) | ((bits >> 16) & 0x7f);
+    const float t = (float)(bits & 0xffff) / 65536.0f;
+    return PNGW_SRGB_ENCODED[index] + (PNGW_SRGB_ENCODED[index + 1] - PNGW_SRGB_ENCODED[index]) * t;
+  }
+
+  // Clamp a linear light sample to the range of 0 to 1 and quantize it to 16 bits, encoding it as
+  // sRGB first unless it is an alpha sample.
+  static pngws_t pngwQuantizeLinear(const float linear, const int is_alpha)
+  {
+    // the comparisons are written so that NaN becomes 0
+    float value = linear > 0.0f ? linear : 0.0f;
+    value = value < 1.0f ? value : 1.0f;
+    if (!is_alpha)
+    {
+      value = pngwEncodedFromLinear(value);
+    }
+    return (pngws_t)(value * 65535.0f + 0.5f);
+  }
+
+  // Convert a row of floating point linear light samples to native byte order 16 bit sRGB samples.
+  static void pngwConvertRowFromFloat(pngws_t* const row, const pngwb_t* const source,
+                                      const size_t width, const pngwcolor_t color,
+                                      const size_t depth)
+  {
+    const size_t channels = (size_t)color;
+    const size_t color_channels =
+        (color == PNGW_COLOR_GA || color == PNGW_COLOR_RGBA) ? channels - 1 : channels;
+    const size_t count = width * channels;
+    if (depth == PNGW_DEPTH_FLOAT32)
+    {
+      for (size_t i = 0; i < count; i += channels)
+      {
+        for (size_t c = i; c < i + color_channels; c++)
+        {
+          row[c] = pngwQuantizeLinear(pngwLoadFloat32(source, c), 0);
+        }
+        for (size_t c = i + color_channels; c < i + channels; c++)
+        {
+          row[c] = pngwQuantizeLinear(pngwLoadFloat32(source, c), 1);
+        }
+      }
+    }
+    else
+    {
+      for (size_t i = 0; i < count; i += channels)
+      {
+        for (size_t c = i; c < i + color_channels; c++)
+        {
+          row[c] = pngwQuantizeLinear(pngwLoadFloat16(source, c), 0);
+        }
+        for (size_t c = i + color_channels; c < i + channels; c++)
+        {
+          row[c] = pngwQuantizeLinear(pngwLoadFloat16(source, c), 1);
+        }
+      }
+    }
+  }
+
   pngwresult_t pngwReadFile(const char* const path, pngwb_t* const data, const size_t row_offset,
                             const size_t width, const size_t height, const size_t depth,
                             const pngwcolor_t color)
@@ -396,7 +1310,7 @@ extern "C"
     {
       return PNGW_RESULT_ERROR_INVALID_COLOR;
     }
-    if (depth != 8 && depth != 16)
+    if (pngwSampleSize(depth) == 0)
     {
       return PNGW_RESULT_ERROR_INVALID_DEPTH;
     }
@@ -442,106 +1356,231 @@ extern "C"
     png_set_sig_bytes(png_ptr, 8);
     png_read_info(png_ptr, info_ptr);
     png_uint_32 png_width, png_height;
-    int png_bit_depth, png_color_type;
-    png_get_IHDR(png_ptr, info_ptr, &png_width, &png_height, &png_bit_depth, &png_color_type, NULL,
-                 NULL, NULL);
-    if (width != (size_t)png_width || (size_t)png_height == 0)
+    png_get_IHDR(png_ptr, info_ptr, &png_width, &png_height, NULL, NULL, NULL, NULL, NULL);
+    if (width != (size_t)png_width || height != (size_t)png_height)
     {
       fclose(f);
       png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
       return PNGW_RESULT_ERROR_INVALID_DIMENSIONS;
     }
-    int load_png_color_type = pngwColorToPngColor(color);
-    int load_png_bit_depth = (int)depth;
-    // if alpha channel not wanted, strip it if the image has one.
-    if ((png_color_type & PNG_COLOR_MASK_ALPHA) && !(load_png_color_type & PNG_COLOR_MASK_ALPHA))
+    // floating point samples are converted from 8 or 16 bit samples, depending on which one loses
+    // no precision
+    const int is_float = (depth & PNGW_DEPTH_FLOAT_BIT) != 0;
+    size_t load_depth = depth;
+    const float* linear_table = NULL;
+    float gamma_table[PNGW_LINEAR_TABLE_16_SIZE];
+    if (is_float)
     {
-      png_set_strip_alpha(png_ptr);
+      load_depth = png_get_bit_depth(png_ptr, info_ptr) == 16 ? 16 : 8;
+      // only images with a gAMA chunk need a table of their own
+      const double gamma = pngwFileGamma(png_ptr, info_ptr);
+      if (gamma == 0.0)
+      {
+        linear_table = load_depth == 16 ? PNGW_SRGB_LINEAR_16 : PNGW_SRGB_LINEAR_8;
+      }
+      else
+      {
+        pngwFillLinearTable(gamma_table, load_depth, gamma);
+        linear_table = gamma_table;
+      }
     }
-    // if expecting an alpha channel and none exists in the image, add a fully opaque alpha value to
-    // each pixel
-    if ((load_png_color_type & PNG_COLOR_MASK_ALPHA) &&
-        (png_color_type == PNG_COLOR_TYPE_GRAY || png_color_type == PNG_COLOR_TYPE_RGB ||
-         png_color_type == PNG_COLOR_TYPE_PALETTE))
+    pngwSetReadTransforms(png_ptr, info_ptr, load_depth, color);
+    // interlaced images are read in multiple passes, with each pass filling in more of every row
+    const int pass_count = png_set_interlace_handling(png_ptr);
+    int actual_row_offset;
+    if (row_offset == PNGW_DEFAULT_ROW_OFFSET)
     {
-      png_set_filler(png_ptr, 0xffff, PNG_FILLER_AFTER);
+      actual_row_offset = width * (size_t)color * pngwSampleSize(depth);
     }
-    // if multiple pixels are packed per byte on 8 bit depth, seperate them into seperate bytes
-    // cleanly
-    if (png_bit_depth < 8 && load_png_bit_depth == 8)
+    else
     {
-      png_set_packing(png_ptr);
+      actual_row_offset = row_offset;
     }
-    // if the image has bit depth 16 and 8 is wanted, auto convert it to bit depth 8
-    if (png_bit_depth == 16 && load_png_bit_depth == 8)
+    // the integer samples of floating point rows are read into the end of each row, where they are
+    // not overwritten by the floating point samples before they are converted
+    const size_t load_row_start =
+        width * (size_t)color * (pngwSampleSize(depth) - pngwSampleSize(load_depth));
+    /* Load the pixels */
+    for (int pass = 0; pass < pass_count; pass++)
     {
-#    ifdef PNG_READ_SCALE_16_TO_8_SUPPORTED
-      png_set_scale_16(png_ptr);
-#    else
-      png_set_strip_16(png_ptr);  // if scaling not supported, strip off the excess byte instead
-#    endif
+      for (size_t y = 0; y < height; y++)
+      {
+        png_bytep row_start = &data[y * actual_row_offset];
+        png_read_row(png_ptr, row_start + load_row_start, NULL);
+        // a row is complete after it is read in the last pass
+        if (is_float && pass == pass_count - 1)
+        {
+          pngwConvertRowToFloat(row_start, width, color, depth, load_depth, linear_table);
+        }
+      }
     }
-    // swap bytes
-    if (png_bit_depth == 16 && pngwIsLittleEndianMachine())
+    /* Cleanup */
+    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+    fclose(f);
+    return PNGW_RESULT_OK;
+  }
+
+  static void pngwProgressiveInfoCallback(png_structp png_ptr, png_infop info_ptr)
+  {
+    pngwprogressive_t* const progressive = (pngwprogressive_t*)png_get_progressive_ptr(png_ptr);
+    png_uint_32 png_width, png_height;
+    png_get_IHDR(png_ptr, info_ptr, &png_width, &png_height, NULL, NULL, NULL, NULL, NULL);
+    if (progressive->width != (size_t)png_width || progressive->height != (size_t)png_height)
     {
-      png_set_swap(png_ptr);
+      progressive->result = PNGW_RESULT_ERROR_INVALID_DIMENSIONS;
+      png_error(png_ptr, "image dimensions do not match");
     }
-    // if image has less than 16 bit depth and 16 is wanted, upscale it to 16
-    if (png_bit_depth < 16 && load_png_bit_depth == 16)
+    pngwSetReadTransforms(png_ptr, info_ptr, progressive->depth, progressive->color);
+    progressive->pass_count = (size_t)png_set_interlace_handling(png_ptr);
+    png_read_update_info(png_ptr, info_ptr);
+  }
+
+  // Report the passes of a progressive read before the given pass as complete. libpng does not give
+  // rows for passes that hold no pixels, so these are reported along with the next pass.
+  static void pngwProgressiveCompletePasses(pngwprogressive_t* const progressive, const size_t pass)
+  {
+    for (; progressive->pass < pass; progressive->pass++)
     {
-      png_set_expand_16(png_ptr);
+      if (progressive->pass_fn != NULL)
+      {
+        progressive->pass_fn(progressive->user, progressive->pass, progressive->pass_count);
+      }
     }
-    // if gray and bit depth is less than 8, up it to 8
-    if ((png_color_type == PNG_COLOR_TYPE_GRAY || png_color_type == PNG_COLOR_TYPE_GRAY_ALPHA) &&
-        png_bit_depth < 8)
+  }
+
+  static void pngwProgressiveRowCallback(png_structp png_ptr, png_bytep new_row,
+                                         png_uint_32 row_num, int pass)
+  {
+    pngwprogressive_t* const progressive = (pngwprogressive_t*)png_get_progressive_ptr(png_ptr);
+    // the first row of a pass means that the previous passes are complete
+    pngwProgressiveCompletePasses(progressive, (size_t)pass);
+    // with interlace handling, libpng gives rows of incomplete passes with each decoded pixel
+    // repeated over the pixels that are not decoded yet, and repeats each row down over the rows
+    // that are not decoded yet. Combining them gives the preview.
+    png_progressive_combine_row(png_ptr, &progressive->data[row_num * progressive->row_offset],
+                                new_row);
+  }
+
+  static void pngwProgressiveEndCallback(png_structp png_ptr, png_infop info_ptr)
+  {
+    (void)info_ptr;
+    pngwprogressive_t* const progressive = (pngwprogressive_t*)png_get_progressive_ptr(png_ptr);
+    progressive->done = 1;
+    pngwProgressiveCompletePasses(progressive, progressive->pass_count);
+  }
+
+  pngwresult_t pngwProgressiveBegin(pngwprogressive_t* const progressive, pngwb_t* const data,
+                                    const size_t row_offset, const size_t width,
+                                    const size_t height, const size_t depth,
+                                    const pngwcolor_t color, const pngwpassfn_t pass_fn,
+                                    void* const user)
+  {
+    if (progressive == NULL || data == NULL)
     {
-      png_set_expand_gray_1_2_4_to_8(png_ptr);
+      return PNGW_RESULT_ERROR_NULL_ARG;
     }
-    // auto convert palette images into rgb or rgba
-    if (png_color_type == PNG_COLOR_TYPE_PALETTE)
+    /* Initial arg checks */
+    if (!(color >= PNGW_COLOR_G && color <= PNGW_COLOR_RGBA))
     {
-      png_set_palette_to_rgb(png_ptr);
+      return PNGW_RESULT_ERROR_INVALID_COLOR;
     }
-    // set transparency to full alpha channels
-    if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS) != 0)
+    if (depth != 8 && depth != 16)
     {
-      png_set_tRNS_to_alpha(png_ptr);
+      return PNGW_RESULT_ERROR_INVALID_DEPTH;
     }
-    // set rgb image to gray output or vice versa
-    if ((load_png_color_type == PNG_COLOR_TYPE_GRAY ||
-         load_png_color_type == PNG_COLOR_TYPE_GRAY_ALPHA) &&
-        (png_color_type == PNG_COLOR_TYPE_RGB || png_color_type == PNG_COLOR_TYPE_RGB_ALPHA ||
-         png_color_type == PNG_COLOR_TYPE_PALETTE))
+    if (width == 0 || height == 0)
     {
-      // negative weights causes default calculation to be used  ((6969 * R + 23434 * G + 2365 *
-      // B)/32768)
-      png_set_rgb_to_gray_fixed(
-          png_ptr, 1, -1.0,
-          -1.0);  // error action 1 causes no waring warning if image was not actually gray
+      return PNGW_RESULT_ERROR_INVALID_DIMENSIONS;
     }
-    if ((load_png_color_type == PNG_COLOR_TYPE_RGB || load_png_color_type == PNG_COLOR_TYPE_RGBA) &&
-        (png_color_type == PNG_COLOR_TYPE_GRAY || png_color_type == PNG_COLOR_TYPE_GRAY_ALPHA))
+    /* Create libpng structs */
+    png_structp png_ptr;
+    png_infop info_ptr;
+    png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (!png_ptr)
     {
-      png_set_gray_to_rgb(png_ptr);
+      return PNGW_RESULT_ERROR_OUT_OF_MEMORY;
     }
-    int actual_row_offset;
+    info_ptr = png_create_info_struct(png_ptr);
+    if (!info_ptr)
+    {
+      png_destroy_read_struct(&png_ptr, NULL, NULL);
+      return PNGW_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    progressive->png_ptr = png_ptr;
+    progressive->info_ptr = info_ptr;
+    progressive->data = data;
     if (row_offset == PNGW_DEFAULT_ROW_OFFSET)
     {
-      actual_row_offset = width * (size_t)color * (depth / 8);
+      progressive->row_offset = width * (size_t)color * (depth / 8);
     }
     else
     {
-      actual_row_offset = row_offset;
+      progressive->row_offset = row_offset;
     }
-    /* Load the pixels */
-    for (size_t y = 0; y < height; y++)
+    progressive->width = width;
+    progressive->height = height;
+    progressive->depth = depth;
+    progressive->color = color;
+    progressive->pass_fn = pass_fn;
+    progressive->user = user;
+    progressive->pass = 0;
+    progressive->pass_count = 1;
+    progressive->done = 0;
+    progressive->result = PNGW_RESULT_OK;
+    png_set_progressive_read_fn(png_ptr, progressive, pngwProgressiveInfoCallback,
+                                pngwProgressiveRowCallback, pngwProgressiveEndCallback);
+    return PNGW_RESULT_OK;
+  }
+
+  pngwresult_t pngwProgressivePush(pngwprogressive_t* const progressive, const pngwb_t* const bytes,
+                                   const size_t size)
+  {
+    if (progressive == NULL || progressive->png_ptr == NULL || (bytes == NULL && size != 0))
     {
-      png_bytep row_start = &data[y * actual_row_offset];
-      png_read_row(png_ptr, row_start, NULL);
+      return PNGW_RESULT_ERROR_NULL_ARG;
+    }
+    if (progressive->result != PNGW_RESULT_OK)
+    {
+      return progressive->result;
+    }
+    png_structp png_ptr = (png_structp)progressive->png_ptr;
+    png_infop info_ptr = (png_infop)progressive->info_ptr;
+    /* Create jump buffer to handle errors */
+    if (setjmp(png_jmpbuf(png_ptr)))
+    {
+      // callbacks set a more specific result before raising an error
+      if (progressive->result == PNGW_RESULT_OK)
+      {
+        progressive->result = PNGW_RESULT_ERROR_JUMP_BUFFER_CALLED;
+      }
+      return progressive->result;
+    }
+    png_process_data(png_ptr, info_ptr, (png_bytep)bytes, size);
+    return PNGW_RESULT_OK;
+  }
+
+  pngwresult_t pngwProgressiveEnd(pngwprogressive_t* const progressive)
+  {
+    if (progressive == NULL)
+    {
+      return PNGW_RESULT_ERROR_NULL_ARG;
+    }
+    if (progressive->png_ptr != NULL)
+    {
+      png_structp png_ptr = (png_structp)progressive->png_ptr;
+      png_infop info_ptr = (png_infop)progressive->info_ptr;
+      png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+      progressive->png_ptr = NULL;
+      progressive->info_ptr = NULL;
+    }
+    if (progressive->result != PNGW_RESULT_OK)
+    {
+      return progressive->result;
+    }
+    if (!progressive->done)
+    {
+      return PNGW_RESULT_ERROR_INCOMPLETE_DATA;
     }
-    /* Cleanup */
-    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-    fclose(f);
     return PNGW_RESULT_OK;
   }
 
@@ -575,10 +1614,25 @@ extern "C"
       png_destroy_write_struct(&png_ptr, NULL);
       return PNGW_RESULT_ERROR_OUT_OF_MEMORY;
     }
+    // floating point samples are quantized to 16 bit samples one row at a time
+    const int is_float = (depth & PNGW_DEPTH_FLOAT_BIT) != 0;
+    const size_t write_depth = is_float ? 16 : depth;
+    pngws_t* quantized_row = NULL;
+    if (is_float)
+    {
+      quantized_row = (pngws_t*)png_malloc_warn(png_ptr, width * (size_t)color * 2);
+      if (quantized_row == NULL)
+      {
+        fclose(f);
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        return PNGW_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+    }
     /* Create jump buffer to handle errors */
     if (setjmp(png_jmpbuf(png_ptr)))
     {
       fclose(f);
+      png_free(png_ptr, quantized_row);
       png_destroy_write_struct(&png_ptr, &info_ptr);
       return PNGW_RESULT_ERROR_JUMP_BUFFER_CALLED;
     }
@@ -587,18 +1641,23 @@ extern "C"
     png_init_io(png_ptr, f);
     // Set the compression to a setup that will be good enough. No need for more complicated options
     // in this library.
-    png_set_IHDR(png_ptr, info_ptr, (uint32_t)width, (uint32_t)height, (int)depth, png_color_type,
-                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+    png_set_IHDR(png_ptr, info_ptr, (uint32_t)width, (uint32_t)height, (int)write_depth,
+                 png_color_type, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
+                 PNG_FILTER_TYPE_BASE);
+    if (is_float)
+    {
+      png_set_sRGB_gAMA_and_cHRM(png_ptr, info_ptr, PNG_sRGB_INTENT_PERCEPTUAL);
+    }
     png_write_info(png_ptr, info_ptr);
     // swap if writing 16 bit image on little endian machine
-    if (png_bit_depth == 16 && pngwIsLittleEndianMachine())
+    if (write_depth == 16 && pngwIsLittleEndianMachine())
     {
       png_set_swap(png_ptr);
     }
     int actual_row_offset;
     if (row_offset == PNGW_DEFAULT_ROW_OFFSET)
     {
-      actual_row_offset = width * (size_t)color * (depth / 8);
+      actual_row_offset = width * (size_t)color * pngwSampleSize(depth);
     }
     else
     {
@@ -607,14 +1666,216 @@ extern "C"
     for (size_t y = 0; y < height; y++)
     {
       png_const_bytep row_start = data + (y * actual_row_offset);
+      if (is_float)
+      {
+        pngwConvertRowFromFloat(quantized_row, row_start, width, color, depth);
+        row_start = (png_const_bytep)quantized_row;
+      }
       png_write_row(png_ptr, row_start);
     }
     png_write_end(png_ptr, info_ptr);
     fclose(f);
+    png_free(png_ptr, quantized_row);
     png_destroy_write_struct(&png_ptr, &info_ptr);
     return PNGW_RESULT_OK;
   }
 
+  // Check if atlas image a is packed before atlas image b. Taller images are packed first, and
+  // images of the same height are packed in the order they were given.
+  static int pngwAtlasPackedBefore(const pngwatlasrect_t* const rects, const size_t a,
+                                   const size_t b)
+  {
+    if (rects[a].height != rects[b].height)
+    {
+      return rects[a].height > rects[b].height;
+    }
+    return a < b;
+  }
+
+  // Move an image index down the heap of pngwSortAtlasOrder() until the heap is in order again.
+  static void pngwSiftAtlasOrder(size_t* const order, const pngwatlasrect_t* const rects,
+                                 size_t root, const size_t end)
+  {
+    for (;;)
+    {
+      size_t child = root * 2 + 1;
+      if (child >= end)
+      {
+        return;
+      }
+      if (child + 1 < end && pngwAtlasPackedBefore(rects, order[child], order[child + 1]))
+      {
+        child++;
+      }
+      if (!pngwAtlasPackedBefore(rects, order[root], order[child]))
+      {
+        return;
+      }
+      const size_t swap = order[root];
+      order[root] = order[child];
+      order[child] = swap;
+      root = child;
+    }
+  }
+
+  // Sort the indices of atlas images into packing order. This is a heap sort, so it needs no
+  // memory besides the order array itself.
+  static void pngwSortAtlasOrder(size_t* const order, const size_t count,
+                                 const pngwatlasrect_t* const rects)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      order[i] = i;
+    }
+    // the root of the heap is the image that is packed last
+    for (size_t start = count / 2; start-- > 0;)
+    {
+      pngwSiftAtlasOrder(order, rects, start, count);
+    }
+    for (size_t end = count - 1; end > 0; end--)
+    {
+      const size_t swap = order[0];
+      order[0] = order[end];
+      order[end] = swap;
+      pngwSiftAtlasOrder(order, rects, 0, end);
+    }
+  }
+
+  pngwresult_t pngwPackAtlas(const char* const* const paths, const size_t count,
+                             const size_t max_width, const size_t padding,
+                             pngwatlasrect_t* const rects, size_t* const order,
+                             size_t* const atlas_width, size_t* const atlas_height)
+  {
+    if (paths == NULL || rects == NULL || order == NULL)
+    {
+      return PNGW_RESULT_ERROR_NULL_ARG;
+    }
+    if (count == 0 || max_width == 0)
+    {
+      return PNGW_RESULT_ERROR_INVALID_DIMENSIONS;
+    }
+    /* Get the dimensions of each file */
+    pngwresult_t result = PNGW_RESULT_OK;
+#    ifdef _OPENMP
+#      pragma omp parallel for
+#    endif
+    for (ptrdiff_t i = 0; i < (ptrdiff_t)count; i++)
+    {
+      const pngwresult_t info_result =
+          pngwFileInfo(paths[i], &rects[i].width, &rects[i].height, NULL, NULL);
+      if (info_result != PNGW_RESULT_OK)
+      {
+#    ifdef _OPENMP
+#      pragma omp critical(pngw_atlas_result)
+#    endif
+        result = info_result;
+      }
+    }
+    if (result != PNGW_RESULT_OK)
+    {
+      return result;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+      if (rects[i].width > max_width)
+      {
+        return PNGW_RESULT_ERROR_INVALID_DIMENSIONS;
+      }
+    }
+    /* Sort the images from tallest to shortest */
+    pngwSortAtlasOrder(order, count, rects);
+    /* Pack the sorted images into shelves from top to bottom */
+    size_t shelf_x = 0, shelf_y = 0, shelf_height = 0, width = 0;
+    for (size_t placed = 0; placed < count; placed++)
+    {
+      pngwatlasrect_t* const rect = &rects[order[placed]];
+      if (placed == 0)
+      {
+        shelf_height = rect->height;
+      }
+      else if (shelf_x + rect->width > max_width)
+      {
+        // images are placed from tallest to shortest, so the first image of a shelf is its tallest
+        shelf_x = 0;
+        shelf_y += shelf_height + padding;
+        shelf_height = rect->height;
+      }
+      rect->x = shelf_x;
+      rect->y = shelf_y;
+      shelf_x += rect->width + padding;
+      if (rect->x + rect->width > width)
+      {
+        width = rect->x + rect->width;
+      }
+    }
+    const size_t height = shelf_y + shelf_height;
+    for (size_t i = 0; i < count; i++)
+    {
+      rects[i].u0 = (float)rects[i].x / (float)width;
+      rects[i].v0 = (float)rects[i].y / (float)height;
+      rects[i].u1 = (float)(rects[i].x + rects[i].width) / (float)width;
+      rects[i].v1 = (float)(rects[i].y + rects[i].height) / (float)height;
+    }
+    if (atlas_width != NULL)
+    {
+      *atlas_width = width;
+    }
+    if (atlas_height != NULL)
+    {
+      *atlas_height = height;
+    }
+    return PNGW_RESULT_OK;
+  }
+
+  pngwresult_t pngwReadAtlas(const char* const* const paths, const size_t count,
+                             const pngwatlasrect_t* const rects, pngwb_t* const data,
+                             const size_t atlas_width, const size_t atlas_height,
+                             const size_t depth, const pngwcolor_t color)
+  {
+    if (paths == NULL || rects == NULL || data == NULL)
+    {
+      return PNGW_RESULT_ERROR_NULL_ARG;
+    }
+    /* Initial arg checks */
+    if (!(color >= PNGW_COLOR_G && color <= PNGW_COLOR_RGBA))
+    {
+      return PNGW_RESULT_ERROR_INVALID_COLOR;
+    }
+    if (pngwSampleSize(depth) == 0)
+    {
+      return PNGW_RESULT_ERROR_INVALID_DEPTH;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+      if (rects[i].x + rects[i].width > atlas_width ||
+          rects[i].y + rects[i].height > atlas_height)
+      {
+        return PNGW_RESULT_ERROR_INVALID_DIMENSIONS;
+      }
+    }
+    const size_t pixel_size = (size_t)color * pngwSampleSize(depth);
+    const size_t row_offset = atlas_width * pixel_size;
+    /* Read each file directly into its place in the atlas */
+    pngwresult_t result = PNGW_RESULT_OK;
+#    ifdef _OPENMP
+#      pragma omp parallel for schedule(dynamic)
+#    endif
+    for (ptrdiff_t i = 0; i < (ptrdiff_t)count; i++)
+    {
+      pngwb_t* const start = &data[rects[i].y * row_offset + rects[i].x * pixel_size];
+      const pngwresult_t read_result = pngwReadFile(paths[i], start, row_offset, rects[i].width,
+                                                    rects[i].height, depth, color);
+      if (read_result != PNGW_RESULT_OK)
+      {
+#    ifdef _OPENMP
+#      pragma omp critical(pngw_atlas_result)
+#    endif
+        result = read_result;
+      }
+    }
+    return result;
+  }
+
   pngwb_t pngGrayFromColor8(const pngwb_t r, const pngwb_t g, const pngwb_t b)
   {
     return ((((6969 * ((uint32_t)r))) + (23434 * ((uint32_t)g)) + (2365 * ((uint32_t)b))) / 32768);
@@ -625,6 +1886,85 @@ extern "C"
     return ((((6969 * ((uint64_t)r))) + (23434 * ((uint64_t)g)) + (2365 * ((uint64_t)b))) / 32768);
   }
 
+  pngws_t pngwFloatToHalf(const float value)
+  {
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t magnitude = bits & 0x7fffffff;
+    // infinity and NaN
+    if (magnitude >= 0x7f800000)
+    {
+      return (pngws_t)(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0));
+    }
+    // too large for a half, which rounds to infinity
+    if (magnitude >= 0x477ff000)
+    {
+      return (pngws_t)(sign | 0x7c00);
+    }
+    // too small for a normal half, so it is rounded to a subnormal half or 0
+    if (magnitude < 0x38800000)
+    {
+      if (magnitude < 0x33000000)
+      {
+        return (pngws_t)sign;
+      }
+      const uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+      const uint32_t shift = 126 - (magnitude >> 23);
+      uint32_t half = mantissa >> shift;
+      const uint32_t remainder = mantissa & ((1u << shift) - 1);
+      const uint32_t halfway = 1u << (shift - 1);
+      if (remainder > halfway || (remainder == halfway && (half & 1)))
+      {
+        half++;
+      }
+      return (pngws_t)(sign | half);
+    }
+    // rebias the exponent and round the mantissa to nearest even. A carry out of the mantissa
+    // correctly increments the exponent.
+    uint32_t half = (magnitude >> 13) - (112 << 10);
+    const uint32_t remainder = magnitude & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    {
+      half++;
+    }
+    return (pngws_t)(sign | half);
+  }
+
+  float pngwHalfToFloat(const pngws_t half)
+  {
+    const uint32_t sign = ((uint32_t)half & 0x8000) << 16;
+    uint32_t exponent = ((uint32_t)half >> 10) & 0x1f;
+    uint32_t mantissa = (uint32_t)half & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f)
+    {
+      bits = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+      bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0)
+    {
+      bits = sign;
+    }
+    else
+    {
+      // normalize the subnormal half
+      exponent = 113;
+      while ((mantissa & 0x400) == 0)
+      {
+        mantissa <<= 1;
+        exponent--;
+      }
+      bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    float value;
+    memcpy(&value, &bits, 4);
+    return value;
+  }
+
   int pngwColorToPngColor(const pngwcolor_t color)
   {
     switch (color)
@@ -665,9 +2005,9 @@ extern "C"
 
   int pngwIsLittleEndianMachine()
   {
-    uint16_t integer = 32769; 
-    char *c = (char*)&integer;
-    return c[0] == 1 && c[1] == 127;
+    const uint16_t integer = 0x8001;
+    const unsigned char* const c = (const unsigned char*)&integer;
+    return c[0] == 0x01 && c[1] == 0x80;
   }
 
 #  endif
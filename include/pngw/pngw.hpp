@@ -0,0 +1,319 @@
+// SPDX-FileCopyrightText: 2022-2024 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2022-2024 Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+   pngw.hpp
+   C++20 layer over png_wrapper.h
+
+   This header adds a thin C++ interface on top of the C functions in png_wrapper.h. It does not
+   replace the C implementation, so png_wrapper.h must still be implemented in exactly one source
+   file as described in png_wrapper.h. That source file may be either C or C++.
+
+   The pixel format of a pngw::Image is part of its type, so the depth and color type passed to
+   pngwReadFile() and pngwWriteFile() are compile time constants and do not have to be carried
+   around next to the pixel bytes. Images own their pixel bytes and can be moved but not copied.
+   Pixel bytes are allocated from a std::pmr::memory_resource, which is the default memory resource
+   unless one is passed to the constructor.
+
+           pngw::Image<PNGW_COLOR_RGBA, 8> image;
+           pngwresult_t result = image.read("dude.png");
+           if (result != PNGW_RESULT_OK)
+           {
+               printf("error reading image: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+               return 1;
+           }
+           for (pngwb_t& sample : image.row(0))
+           {
+               sample = 0;
+           }
+           result = image.write("new_dude.png");
+
+   Just like the C functions, the member functions of pngw::Image report errors by returning a
+   pngwresult_t. Running out of memory while allocating pixel bytes returns
+   PNGW_RESULT_ERROR_OUT_OF_MEMORY instead of throwing.
+
+   The pngw_bench target of the example project times pngw::Image::read() against the C calls it
+   wraps.
+*/
+
+#ifndef PNGW_HPP
+#define PNGW_HPP
+
+#include <pngw/png_wrapper.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace pngw
+{
+  // Compile time information about a pixel format. Depth must be 8, 16, PNGW_DEPTH_FLOAT16 or
+  // PNGW_DEPTH_FLOAT32. Color may not be PNGW_COLOR_PALETTE. PNGW_DEPTH_FLOAT16 samples are half
+  // precision floats stored as pngws_t, which can be converted with pngwHalfToFloat().
+  template <pngwcolor_t Color, size_t Depth>
+  struct PixelTraits
+  {
+    static_assert(Color >= PNGW_COLOR_G && Color <= PNGW_COLOR_RGBA, "invalid color type");
+    static_assert(Depth == 8 || Depth == 16 || Depth == PNGW_DEPTH_FLOAT16 ||
+                      Depth == PNGW_DEPTH_FLOAT32,
+                  "invalid bit depth");
+
+    using sample_type = std::conditional_t<
+        Depth == 8, pngwb_t, std::conditional_t<Depth == PNGW_DEPTH_FLOAT32, float, pngws_t>>;
+
+    static constexpr pngwcolor_t color = Color;
+    static constexpr size_t depth = Depth;
+    static constexpr size_t channels = (size_t)Color;
+    static constexpr size_t sample_size = sizeof(sample_type);
+    static constexpr size_t pixel_size = channels * sample_size;
+    static constexpr bool has_alpha = Color == PNGW_COLOR_GA || Color == PNGW_COLOR_RGBA;
+
+    // Get the size of a single row of pixels in bytes.
+    static constexpr size_t rowSize(const size_t width) noexcept
+    {
+      return width * pixel_size;
+    }
+
+    // Get the size of image data in bytes. This is the same as the size returned by
+    // pngwDataSize().
+    static constexpr size_t dataSize(const size_t width, const size_t height) noexcept
+    {
+      return rowSize(width) * height;
+    }
+  };
+
+  // Pixel bytes of a png image with a pixel format known at compile time.
+  template <pngwcolor_t Color, size_t Depth>
+  class Image
+  {
+  public:
+    using traits = PixelTraits<Color, Depth>;
+    using sample_type = typename traits::sample_type;
+    using allocator_type = std::pmr::polymorphic_allocator<pngwb_t>;
+
+    Image() noexcept = default;
+
+    explicit Image(const allocator_type& allocator) noexcept
+        : resource_(allocator.resource())
+    {
+    }
+
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    Image(Image&& other) noexcept
+        : resource_(other.resource_),
+          data_(std::exchange(other.data_, nullptr)),
+          width_(std::exchange(other.width_, 0)),
+          height_(std::exchange(other.height_, 0))
+    {
+    }
+
+    // The moved from image's memory resource is adopted along with its pixel bytes.
+    Image& operator=(Image&& other) noexcept
+    {
+      if (this != &other)
+      {
+        this->release();
+        this->resource_ = other.resource_;
+        this->data_ = std::exchange(other.data_, nullptr);
+        this->width_ = std::exchange(other.width_, 0);
+        this->height_ = std::exchange(other.height_, 0);
+      }
+      return *this;
+    }
+
+    ~Image()
+    {
+      this->release();
+    }
+
+    // Allocate pixel bytes for an image of the given dimensions. Any pixel bytes that the image
+    // already owns are released, unless they are already of the same size in which case they are
+    // reused. The contents of the pixel bytes are left uninitialized.
+    pngwresult_t allocate(const size_t width, const size_t height)
+    {
+      if (width == 0 || height == 0)
+      {
+        return PNGW_RESULT_ERROR_INVALID_DIMENSIONS;
+      }
+      if (this->data_ != nullptr && traits::dataSize(width, height) == this->size())
+      {
+        this->width_ = width;
+        this->height_ = height;
+        return PNGW_RESULT_OK;
+      }
+      this->release();
+      try
+      {
+        this->data_ = static_cast<pngwb_t*>(
+            this->resource_->allocate(traits::dataSize(width, height), alignof(sample_type)));
+      }
+      catch (const std::bad_alloc&)
+      {
+        return PNGW_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+      this->width_ = width;
+      this->height_ = height;
+      return PNGW_RESULT_OK;
+    }
+
+    // Release the pixel bytes owned by the image, leaving it empty.
+    void release() noexcept
+    {
+      if (this->data_ != nullptr)
+      {
+        this->resource_->deallocate(this->data_, this->size(), alignof(sample_type));
+        this->data_ = nullptr;
+      }
+      this->width_ = 0;
+      this->height_ = 0;
+    }
+
+    // Read a png file into the image. The image is resized to the dimensions of the file, and the
+    // file is converted on load to the pixel format of the image. If the file can not be read, the
+    // image is left empty.
+    pngwresult_t read(const char* const path)
+    {
+      size_t width, height;
+      pngwresult_t result = pngwFileInfo(path, &width, &height, nullptr, nullptr);
+      if (result != PNGW_RESULT_OK)
+      {
+        this->release();
+        return result;
+      }
+      result = this->allocate(width, height);
+      if (result != PNGW_RESULT_OK)
+      {
+        return result;
+      }
+      result =
+          pngwReadFile(path, this->data_, PNGW_DEFAULT_ROW_OFFSET, width, height, Depth, Color);
+      if (result != PNGW_RESULT_OK)
+      {
+        this->release();
+      }
+      return result;
+    }
+
+    // Save the image to a png file.
+    pngwresult_t write(const char* const path) const
+    {
+      if (this->data_ == nullptr)
+      {
+        return PNGW_RESULT_ERROR_INVALID_DIMENSIONS;
+      }
+      return pngwWriteFile(path, this->data_, PNGW_DEFAULT_ROW_OFFSET, this->width_,
+                           this->height_, Depth, Color);
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+      return allocator_type(this->resource_);
+    }
+
+    bool empty() const noexcept
+    {
+      return this->data_ == nullptr;
+    }
+
+    size_t width() const noexcept
+    {
+      return this->width_;
+    }
+
+    size_t height() const noexcept
+    {
+      return this->height_;
+    }
+
+    // Get the size of a single row of pixels in bytes.
+    size_t rowSize() const noexcept
+    {
+      return traits::rowSize(this->width_);
+    }
+
+    // Get the size of all pixel bytes of the image.
+    size_t size() const noexcept
+    {
+      return traits::dataSize(this->width_, this->height_);
+    }
+
+    pngwb_t* data() noexcept
+    {
+      return this->data_;
+    }
+
+    const pngwb_t* data() const noexcept
+    {
+      return this->data_;
+    }
+
+    std::span<pngwb_t> bytes() noexcept
+    {
+      return std::span<pngwb_t>(this->data_, this->size());
+    }
+
+    std::span<const pngwb_t> bytes() const noexcept
+    {
+      return std::span<const pngwb_t>(this->data_, this->size());
+    }
+
+    // Get the samples of all pixels, with each channel of a pixel being a seperate sample.
+    std::span<sample_type> samples() noexcept
+    {
+      return std::span<sample_type>(reinterpret_cast<sample_type*>(this->data_),
+                                    this->width_ * this->height_ * traits::channels);
+    }
+
+    std::span<const sample_type> samples() const noexcept
+    {
+      return std::span<const sample_type>(reinterpret_cast<const sample_type*>(this->data_),
+                                          this->width_ * this->height_ * traits::channels);
+    }
+
+    // Get the samples of a single row of pixels.
+    std::span<sample_type> row(const size_t y) noexcept
+    {
+      return this->samples().subspan(y * this->width_ * traits::channels,
+                                     this->width_ * traits::channels);
+    }
+
+    std::span<const sample_type> row(const size_t y) const noexcept
+    {
+      return this->samples().subspan(y * this->width_ * traits::channels,
+                                     this->width_ * traits::channels);
+    }
+
+  private:
+    std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+    pngwb_t* data_ = nullptr;
+    size_t width_ = 0;
+    size_t height_ = 0;
+  };
+}  // namespace pngw
+
+#endif
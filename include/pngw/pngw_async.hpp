@@ -0,0 +1,498 @@
+// SPDX-FileCopyrightText: 2022-2024 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2022-2024 Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+   pngw_async.hpp
+   Asynchronous png reading and writing
+
+   pngw::AsyncPool runs png reads and writes on a fixed amount of worker threads, so that threads
+   that must not block, such as the thread of an event loop, can start them and be told when they
+   are done. Each job is given a callback that is called on a worker thread when the job is
+   complete. Jobs can also be polled, waited on and cancelled through their handles.
+
+           pngw::AsyncPool pool;
+           pngwresult_t result = pool.read<PNGW_COLOR_RGBA, 8>(
+               "dude.png", [](pngw::AsyncRead<PNGW_COLOR_RGBA, 8>& job) {
+                   if (job.result() == PNGW_RESULT_OK)
+                   {
+                       pngw::Image<PNGW_COLOR_RGBA, 8> image = job.take();
+                   }
+               });
+           if (result == PNGW_RESULT_ERROR_QUEUE_FULL)
+           {
+               // too many jobs are waiting, so try again later
+           }
+
+   The amount of jobs that may wait for a worker thread is limited. When the limit is reached, new
+   jobs are refused with PNGW_RESULT_ERROR_QUEUE_FULL instead of blocking the calling thread.
+
+   Files are read in pieces using a progressive read. The worker thread reads each piece and then
+   decodes it before reading the next one, so a job does not hold the whole file in memory.
+   A cancelled job that has not started is completed with PNGW_RESULT_ERROR_CANCELLED without
+   being run, and a read of an 8 or 16 bit depth image that has started stops at the next piece.
+   Reads of floating point depths and writes run to the end once started.
+
+   When the pool is destroyed, jobs that have not started are cancelled and the destructor waits
+   for started jobs to finish. The callback of every accepted job is called exactly once. Jobs that
+   are started by callbacks while the pool is being destroyed are refused with
+   PNGW_RESULT_ERROR_CANCELLED, and their callbacks are not called. If a callback throws, the
+   exception is caught on the worker thread and can be retrieved from the job with exception()
+   once it is done.
+*/
+
+#ifndef PNGW_ASYNC_HPP
+#define PNGW_ASYNC_HPP
+
+#include <pngw/pngw.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pngw
+{
+  // State of a job of an AsyncPool.
+  class AsyncJob
+  {
+  public:
+    AsyncJob() = default;
+    AsyncJob(const AsyncJob&) = delete;
+    AsyncJob& operator=(const AsyncJob&) = delete;
+    virtual ~AsyncJob() = default;
+
+    // Ask for the job to stop. A job that is already done is not affected.
+    void cancel() noexcept
+    {
+      this->cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool cancelled() const noexcept
+    {
+      return this->cancelled_.load(std::memory_order_relaxed);
+    }
+
+    // Check if the job is complete and its callback has returned.
+    bool done() const noexcept
+    {
+      return this->done_.load(std::memory_order_acquire);
+    }
+
+    // Block until the job is done.
+    void wait() const
+    {
+      std::unique_lock<std::mutex> lock(this->mutex_);
+      this->condition_.wait(lock, [this] { return this->done(); });
+    }
+
+    // Get the result of the job. This is only valid inside of the callback or after the job is
+    // done.
+    pngwresult_t result() const noexcept
+    {
+      return this->result_;
+    }
+
+    // Get the exception thrown by the callback of the job, or NULL if it returned normally. This is
+    // only valid after the job is done.
+    std::exception_ptr exception() const noexcept
+    {
+      return this->exception_;
+    }
+
+  protected:
+    pngwresult_t result_ = PNGW_RESULT_OK;
+
+  private:
+    friend class AsyncPool;
+
+    void markDone()
+    {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->done_.store(true, std::memory_order_release);
+      }
+      this->condition_.notify_all();
+    }
+
+    std::exception_ptr exception_;
+    std::atomic<bool> cancelled_{false};
+    std::atomic<bool> done_{false};
+    mutable std::mutex mutex_;
+    mutable std::condition_variable condition_;
+  };
+
+  // Job that reads a png file into an image.
+  template <pngwcolor_t Color, size_t Depth>
+  class AsyncRead : public AsyncJob
+  {
+  public:
+    using image_type = Image<Color, Depth>;
+
+    explicit AsyncRead(std::string path, const typename image_type::allocator_type& allocator)
+        : path_(std::move(path)), image_(allocator)
+    {
+    }
+
+    const std::string& path() const noexcept
+    {
+      return this->path_;
+    }
+
+    // Take the read image out of the job. This is only valid inside of the callback or after the
+    // job is done, and leaves the image of the job empty.
+    image_type take() noexcept
+    {
+      return std::move(this->image_);
+    }
+
+  private:
+    friend class AsyncPool;
+
+    std::string path_;
+    image_type image_;
+  };
+
+  // Job that writes an image to a png file.
+  template <pngwcolor_t Color, size_t Depth>
+  class AsyncWrite : public AsyncJob
+  {
+  public:
+    using image_type = Image<Color, Depth>;
+
+    AsyncWrite(std::string path, std::shared_ptr<const image_type> image)
+        : path_(std::move(path)), image_(std::move(image))
+    {
+    }
+
+    const std::string& path() const noexcept
+    {
+      return this->path_;
+    }
+
+  private:
+    friend class AsyncPool;
+
+    std::string path_;
+    std::shared_ptr<const image_type> image_;
+  };
+
+  // Bounded pool of worker threads that read and write png files.
+  class AsyncPool
+  {
+  public:
+    // Size of the pieces that files are read in.
+    static constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+
+    // Create a pool with the given amount of worker threads, which may have up to capacity jobs
+    // waiting for a worker thread at a time.
+    explicit AsyncPool(
+        const size_t thread_count = std::max(1u, std::thread::hardware_concurrency()),
+        const size_t capacity = 1024)
+        : capacity_(capacity)
+    {
+      try
+      {
+        this->threads_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; i++)
+        {
+          this->threads_.emplace_back([this] { this->work(); });
+        }
+      }
+      catch (...)
+      {
+        // the destructor is not called when the constructor throws, so stop the started threads
+        this->stop();
+        throw;
+      }
+    }
+
+    AsyncPool(const AsyncPool&) = delete;
+    AsyncPool& operator=(const AsyncPool&) = delete;
+
+    ~AsyncPool()
+    {
+      this->stop();
+    }
+
+    // Start reading a png file into a new image. The callback is called on a worker thread when
+    // the read is complete, and may take the image out of the job. If job is not NULL, it is set
+    // to the handle of the started job. The image is allocated from resource, which must be thread
+    // safe.
+    template <pngwcolor_t Color, size_t Depth>
+    pngwresult_t read(std::string path, std::function<void(AsyncRead<Color, Depth>&)> callback,
+                      std::shared_ptr<AsyncRead<Color, Depth>>* const job = nullptr,
+                      std::pmr::memory_resource* const resource = std::pmr::get_default_resource())
+    {
+      std::shared_ptr<AsyncRead<Color, Depth>> read_job;
+      try
+      {
+        read_job = std::make_shared<AsyncRead<Color, Depth>>(
+            std::move(path), typename Image<Color, Depth>::allocator_type(resource));
+      }
+      catch (const std::bad_alloc&)
+      {
+        return PNGW_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+      AsyncRead<Color, Depth>* const raw_job = read_job.get();
+      const pngwresult_t result =
+          this->submit(read_job, [raw_job, callback = std::move(callback)] {
+            if (raw_job->cancelled())
+            {
+              raw_job->result_ = PNGW_RESULT_ERROR_CANCELLED;
+            }
+            else
+            {
+              raw_job->result_ = readImage(raw_job->path_, raw_job->image_, *raw_job);
+            }
+            if (callback)
+            {
+              callback(*raw_job);
+            }
+          });
+      if (result == PNGW_RESULT_OK && job != nullptr)
+      {
+        *job = std::move(read_job);
+      }
+      return result;
+    }
+
+    // Start writing an image to a png file. The image is kept alive until the write is complete.
+    // The callback is called on a worker thread when the write is complete. If job is not NULL, it
+    // is set to the handle of the started job.
+    template <pngwcolor_t Color, size_t Depth>
+    pngwresult_t write(std::string path, std::shared_ptr<const Image<Color, Depth>> image,
+                       std::function<void(AsyncWrite<Color, Depth>&)> callback,
+                       std::shared_ptr<AsyncWrite<Color, Depth>>* const job = nullptr)
+    {
+      if (!image)
+      {
+        return PNGW_RESULT_ERROR_NULL_ARG;
+      }
+      std::shared_ptr<AsyncWrite<Color, Depth>> write_job;
+      try
+      {
+        write_job = std::make_shared<AsyncWrite<Color, Depth>>(std::move(path), std::move(image));
+      }
+      catch (const std::bad_alloc&)
+      {
+        return PNGW_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+      AsyncWrite<Color, Depth>* const raw_job = write_job.get();
+      const pngwresult_t result =
+          this->submit(write_job, [raw_job, callback = std::move(callback)] {
+            if (raw_job->cancelled())
+            {
+              raw_job->result_ = PNGW_RESULT_ERROR_CANCELLED;
+            }
+            else
+            {
+              raw_job->result_ = raw_job->image_->write(raw_job->path_.c_str());
+            }
+            if (callback)
+            {
+              callback(*raw_job);
+            }
+          });
+      if (result == PNGW_RESULT_OK && job != nullptr)
+      {
+        *job = std::move(write_job);
+      }
+      return result;
+    }
+
+    // Get the amount of jobs that are waiting for a worker thread.
+    size_t pending() const
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      return this->queue_.size();
+    }
+
+    size_t capacity() const noexcept
+    {
+      return this->capacity_;
+    }
+
+  private:
+    struct Task
+    {
+      std::shared_ptr<AsyncJob> job;
+      std::function<void()> run;
+    };
+
+    // Cancel the jobs that have not started and wait for all worker threads to finish.
+    void stop()
+    {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->stopping_ = true;
+        for (Task& task : this->queue_)
+        {
+          task.job->cancel();
+        }
+      }
+      this->condition_.notify_all();
+      for (std::thread& thread : this->threads_)
+      {
+        thread.join();
+      }
+    }
+
+    pngwresult_t submit(std::shared_ptr<AsyncJob> job, std::function<void()> run)
+    {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        if (this->stopping_)
+        {
+          return PNGW_RESULT_ERROR_CANCELLED;
+        }
+        if (this->queue_.size() >= this->capacity_)
+        {
+          return PNGW_RESULT_ERROR_QUEUE_FULL;
+        }
+        try
+        {
+          this->queue_.push_back(Task{std::move(job), std::move(run)});
+        }
+        catch (const std::bad_alloc&)
+        {
+          return PNGW_RESULT_ERROR_OUT_OF_MEMORY;
+        }
+      }
+      this->condition_.notify_one();
+      return PNGW_RESULT_OK;
+    }
+
+    void work()
+    {
+      for (;;)
+      {
+        Task task;
+        {
+          std::unique_lock<std::mutex> lock(this->mutex_);
+          this->condition_.wait(lock,
+                                [this] { return this->stopping_ || !this->queue_.empty(); });
+          if (this->queue_.empty())
+          {
+            return;
+          }
+          task = std::move(this->queue_.front());
+          this->queue_.pop_front();
+        }
+        // an exception from a callback is kept in the job, so that the job is still marked as done
+        // and the worker thread keeps running.
+        try
+        {
+          task.run();
+        }
+        catch (...)
+        {
+          task.job->exception_ = std::current_exception();
+        }
+        task.job->markDone();
+      }
+    }
+
+    // Read a png file piece by piece, stopping early if the job is cancelled. Floating point
+    // depths can not be read progressively, so they are read in one call.
+    template <pngwcolor_t Color, size_t Depth>
+    static pngwresult_t readImage(const std::string& path, Image<Color, Depth>& image,
+                                  const AsyncJob& job)
+    {
+      if constexpr (Depth != 8 && Depth != 16)
+      {
+        return image.read(path.c_str());
+      }
+      else
+      {
+        size_t width, height;
+        pngwresult_t result = pngwFileInfo(path.c_str(), &width, &height, nullptr, nullptr);
+        if (result != PNGW_RESULT_OK)
+        {
+          return result;
+        }
+        result = image.allocate(width, height);
+        if (result != PNGW_RESULT_OK)
+        {
+          return result;
+        }
+        std::FILE* const file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+          image.release();
+          return PNGW_RESULT_ERROR_FILE_NOT_FOUND;
+        }
+        pngwprogressive_t progressive;
+        result = pngwProgressiveBegin(&progressive, image.data(), PNGW_DEFAULT_ROW_OFFSET, width,
+                                      height, Depth, Color, nullptr, nullptr);
+        if (result != PNGW_RESULT_OK)
+        {
+          std::fclose(file);
+          image.release();
+          return result;
+        }
+        pngwb_t chunk[READ_CHUNK_SIZE];
+        size_t size;
+        while (result == PNGW_RESULT_OK && (size = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+          if (job.cancelled())
+          {
+            result = PNGW_RESULT_ERROR_CANCELLED;
+            break;
+          }
+          result = pngwProgressivePush(&progressive, chunk, size);
+        }
+        std::fclose(file);
+        const pngwresult_t end_result = pngwProgressiveEnd(&progressive);
+        if (result == PNGW_RESULT_OK)
+        {
+          result = end_result;
+        }
+        if (result != PNGW_RESULT_OK)
+        {
+          image.release();
+        }
+        return result;
+      }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Task> queue_;
+    std::vector<std::thread> threads_;
+    const size_t capacity_;
+    bool stopping_ = false;
+  };
+}  // namespace pngw
+
+#endif
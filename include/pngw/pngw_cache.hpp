@@ -0,0 +1,327 @@
+// SPDX-FileCopyrightText: 2022-2024 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2022-2024 Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+   pngw_cache.hpp
+   Thread safe cache of decoded png images
+
+   pngw::ImageCache keeps recently read images in memory so that reading the same file again is a
+   lookup instead of a decode. Each cache holds images of a single pixel format, which is given by
+   its template arguments just like with pngw::Image. Cached images are tightly packed, so they
+   always use PNGW_DEFAULT_ROW_OFFSET.
+
+           pngw::ImageCache<PNGW_COLOR_RGBA, 8> cache(64 * 1024 * 1024); // 64 MiB budget
+           pngw::ImageCache<PNGW_COLOR_RGBA, 8>::handle_type image;
+           pngwresult_t result = cache.get("dude.png", image);
+           if (result != PNGW_RESULT_OK)
+           {
+               printf("error reading image: %s\n", PNGW_RESULT_DESCRIPTIONS[result]);
+               return 1;
+           }
+
+   Images are shared as read only std::shared_ptr handles. An evicted image stays valid for as long
+   as a handle to it exists, but its bytes no longer count toward the budget of the cache.
+
+   Images are cached by path. The modification time and size of the file are checked on every
+   get(), and the image is read again if either of them changed. If several threads ask for the
+   same image while it is not cached, only the first one reads the file and the others wait for
+   its result. When the decoded bytes of all cached images exceed the byte budget, the least
+   recently used images are evicted.
+*/
+
+#ifndef PNGW_CACHE_HPP
+#define PNGW_CACHE_HPP
+
+#include <pngw/pngw.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+namespace pngw
+{
+  // Counters of an image cache.
+  struct CacheStats
+  {
+    // amount of get() calls that got an image without reading the file, either from the cache or
+    // by waiting for another get() call that was reading the same file.
+    size_t hits = 0;
+    // amount of get() calls that read the file.
+    size_t misses = 0;
+    // amount of images removed to stay within the byte budget.
+    size_t evictions = 0;
+    // amount of images currently cached.
+    size_t entries = 0;
+    // amount of decoded bytes currently cached.
+    size_t bytes = 0;
+  };
+
+  template <pngwcolor_t Color, size_t Depth>
+  class ImageCache
+  {
+  public:
+    using image_type = Image<Color, Depth>;
+    using handle_type = std::shared_ptr<const image_type>;
+
+    // Create a cache that holds up to budget bytes of decoded pixels. Pixel bytes are allocated
+    // from resource, which must be thread safe.
+    explicit ImageCache(
+        const size_t budget,
+        std::pmr::memory_resource* const resource = std::pmr::get_default_resource())
+        : budget_(budget), resource_(resource)
+    {
+    }
+
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    // Get the image of a png file, reading it if it is not cached or if the file changed since it
+    // was cached. On failure, image is reset and the error of the read is returned.
+    pngwresult_t get(const char* const path, handle_type& image)
+    {
+      image.reset();
+      if (path == nullptr)
+      {
+        return PNGW_RESULT_ERROR_NULL_ARG;
+      }
+      std::error_code error;
+      const std::filesystem::file_time_type mtime = std::filesystem::last_write_time(path, error);
+      if (error)
+      {
+        return PNGW_RESULT_ERROR_FILE_NOT_FOUND;
+      }
+      const std::uintmax_t file_size = std::filesystem::file_size(path, error);
+      if (error)
+      {
+        return PNGW_RESULT_ERROR_FILE_NOT_FOUND;
+      }
+      std::unique_lock<std::mutex> lock(this->mutex_);
+      auto it = this->entries_.find(path);
+      if (it != this->entries_.end() &&
+          (it->second.mtime != mtime || it->second.file_size != file_size))
+      {
+        this->erase(it);
+        it = this->entries_.end();
+      }
+      if (it != this->entries_.end())
+      {
+        Entry& entry = it->second;
+        if (entry.image)
+        {
+          this->stats_.hits++;
+          this->lru_.splice(this->lru_.begin(), this->lru_, entry.lru);
+          image = entry.image;
+          return PNGW_RESULT_OK;
+        }
+        // another thread is reading the file, so wait for it to finish. Only a successful read
+        // counts as a hit, a failed one is counted as a miss by the thread that read the file.
+        std::shared_future<Loaded> future = entry.future;
+        lock.unlock();
+        const Loaded& loaded = future.get();
+        if (loaded.first == PNGW_RESULT_OK)
+        {
+          lock.lock();
+          this->stats_.hits++;
+          lock.unlock();
+        }
+        image = loaded.second;
+        return loaded.first;
+      }
+      this->stats_.misses++;
+      const std::string key(path);
+      std::promise<Loaded> promise;
+      std::shared_future<Loaded> future = promise.get_future().share();
+      Entry& entry = this->entries_[key];
+      entry.mtime = mtime;
+      entry.file_size = file_size;
+      entry.generation = ++this->generation_;
+      entry.future = future;
+      const uint64_t generation = entry.generation;
+      lock.unlock();
+
+      try
+      {
+        image_type decoded{typename image_type::allocator_type(this->resource_)};
+        pngwresult_t result = decoded.read(path);
+        Loaded loaded(result, nullptr);
+        if (result == PNGW_RESULT_OK)
+        {
+          loaded.second = std::make_shared<const image_type>(std::move(decoded));
+        }
+
+        lock.lock();
+        it = this->entries_.find(key);
+        if (it != this->entries_.end() && it->second.generation == generation)
+        {
+          if (result == PNGW_RESULT_OK)
+          {
+            // the entry only counts as loaded once it is in the lru list, so that erase() stays
+            // valid if push_front() throws.
+            this->lru_.push_front(it->first);
+            it->second.lru = this->lru_.begin();
+            it->second.image = loaded.second;
+            it->second.size = loaded.second->size();
+            this->stats_.bytes += it->second.size;
+            this->trim();
+          }
+          else
+          {
+            this->entries_.erase(it);
+          }
+        }
+        lock.unlock();
+        promise.set_value(loaded);
+        image = std::move(loaded.second);
+        return result;
+      }
+      catch (const std::bad_alloc&)
+      {
+        this->abandon(lock, key, generation, promise);
+        return PNGW_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+      catch (...)
+      {
+        this->abandon(lock, key, generation, promise);
+        throw;
+      }
+    }
+
+    // Remove the image of a png file from the cache, if it is cached.
+    void invalidate(const char* const path)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      auto it = this->entries_.find(path);
+      if (it != this->entries_.end())
+      {
+        this->erase(it);
+      }
+    }
+
+    // Remove all images from the cache. Reads in progress finish, but their images are not cached.
+    void clear()
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->entries_.clear();
+      this->lru_.clear();
+      this->stats_.bytes = 0;
+    }
+
+    // Change the byte budget, evicting images if the cache no longer fits within it.
+    void setBudget(const size_t budget)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->budget_ = budget;
+      this->trim();
+    }
+
+    size_t budget() const
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      return this->budget_;
+    }
+
+    CacheStats stats() const
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      CacheStats stats = this->stats_;
+      stats.entries = this->lru_.size();
+      return stats;
+    }
+
+  private:
+    using Loaded = std::pair<pngwresult_t, handle_type>;
+
+    struct Entry
+    {
+      std::filesystem::file_time_type mtime;
+      std::uintmax_t file_size = 0;
+      uint64_t generation = 0;
+      std::shared_future<Loaded> future;
+      // NULL while the file is still being read.
+      handle_type image;
+      size_t size = 0;
+      std::list<std::string>::iterator lru;
+    };
+
+    using EntryMap = std::unordered_map<std::string, Entry>;
+
+    // Remove an entry, which may still be loading. Must be called with the mutex locked.
+    void erase(typename EntryMap::iterator it)
+    {
+      if (it->second.image)
+      {
+        this->lru_.erase(it->second.lru);
+        this->stats_.bytes -= it->second.size;
+      }
+      this->entries_.erase(it);
+    }
+
+    // Finish a read that failed with an exception, so that waiting threads get an error instead of
+    // a broken promise and the path is read again by the next get().
+    void abandon(std::unique_lock<std::mutex>& lock, const std::string& key,
+                 const uint64_t generation, std::promise<Loaded>& promise) noexcept
+    {
+      if (!lock.owns_lock())
+      {
+        lock.lock();
+      }
+      auto it = this->entries_.find(key);
+      if (it != this->entries_.end() && it->second.generation == generation)
+      {
+        this->erase(it);
+      }
+      lock.unlock();
+      promise.set_value(Loaded(PNGW_RESULT_ERROR_OUT_OF_MEMORY, nullptr));
+    }
+
+    // Evict least recently used images until the cache fits the budget. Must be called with the
+    // mutex locked.
+    void trim()
+    {
+      while (this->stats_.bytes > this->budget_ && !this->lru_.empty())
+      {
+        this->erase(this->entries_.find(this->lru_.back()));
+        this->stats_.evictions++;
+      }
+    }
+
+    mutable std::mutex mutex_;
+    size_t budget_;
+    std::pmr::memory_resource* resource_;
+    uint64_t generation_ = 0;
+    EntryMap entries_;
+    // paths of loaded entries, from most to least recently used.
+    std::list<std::string> lru_;
+    CacheStats stats_;
+  };
+}  // namespace pngw
+
+#endif